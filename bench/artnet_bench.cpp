@@ -0,0 +1,341 @@
+// Send path benchmark. Drives the native output (the code behind
+// ArtNetController) against a stand-in receiver on loopback and reports
+// throughput, per-call latency, CPU time, allocations and packet jitter.
+//
+//   artnet_bench [--universes N] [--rate HZ] [--seconds S] [--mode sync|thread]
+//                [--delta] [--static] [--port PORT] [--shards N]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "artnet_output.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Every heap allocation in the process goes through these, so the count
+// covers the sender thread as well as the calling thread.
+static std::atomic<uint64_t> allocation_count{ 0 };
+
+void *operator new(std::size_t size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	// The library may be built without exceptions; running out of memory in a
+	// benchmark is fatal either way.
+	std::abort();
+}
+
+void *operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	size_t align = static_cast<size_t>(alignment);
+	size = (size + align - 1) / align * align;
+#ifdef _WIN32
+	void *ptr = _aligned_malloc(size, align);
+#else
+	void *ptr = std::aligned_alloc(align, size);
+#endif
+	if (!ptr) {
+		std::abort();
+	}
+	return ptr;
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+	return operator new(size, alignment);
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept {
+#ifdef _WIN32
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
+#endif
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept {
+	operator delete(ptr, alignment);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t alignment) noexcept {
+	operator delete(ptr, alignment);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t alignment) noexcept {
+	operator delete(ptr, alignment);
+}
+
+namespace {
+
+struct Options {
+	int universes = 64;
+	double rate = 44.0;
+	double seconds = 5.0;
+	bool threaded = true;
+	bool delta = false;
+	bool static_data = false;
+	uint16_t port = 16454;
+	int shards = 1;
+};
+
+bool parse_options(int argc, char **argv, Options &r_options) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--universes" && has_value) {
+			r_options.universes = std::clamp(std::atoi(argv[++i]), 1, static_cast<int>(ARTNET_MAX_PORT_ADDRESS) + 1);
+		} else if (arg == "--rate" && has_value) {
+			r_options.rate = std::clamp(std::atof(argv[++i]), ArtNetOutput::MIN_REFRESH_RATE, ArtNetOutput::MAX_REFRESH_RATE);
+		} else if (arg == "--seconds" && has_value) {
+			r_options.seconds = std::max(std::atof(argv[++i]), 0.1);
+		} else if (arg == "--mode" && has_value) {
+			std::string mode = argv[++i];
+			if (mode != "sync" && mode != "thread") {
+				return false;
+			}
+			r_options.threaded = mode == "thread";
+		} else if (arg == "--delta") {
+			r_options.delta = true;
+		} else if (arg == "--static") {
+			r_options.static_data = true;
+		} else if (arg == "--port" && has_value) {
+			r_options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+		} else if (arg == "--shards" && has_value) {
+			r_options.shards = std::clamp(std::atoi(argv[++i]), 1, static_cast<int>(ArtNetOutput::MAX_SHARDS));
+		} else {
+			return false;
+		}
+	}
+	return r_options.port != 0 && r_options.port != 65535;
+}
+
+double cpu_seconds() {
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	auto to_seconds = [](const FILETIME &time) {
+		return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 1e7;
+	};
+	return to_seconds(kernel) + to_seconds(user);
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+double percentile(std::vector<double> &samples, double fraction) {
+	if (samples.empty()) {
+		return 0.0;
+	}
+	size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * (samples.size() - 1) + 0.5));
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return samples[index];
+}
+
+void print_latency(const char *name, std::vector<double> &samples) {
+	double p50 = percentile(samples, 0.50);
+	double p90 = percentile(samples, 0.90);
+	double p99 = percentile(samples, 0.99);
+	double p999 = percentile(samples, 0.999);
+	double max = samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+	std::printf("%-18s p50 %.2f us  p90 %.2f us  p99 %.2f us  p99.9 %.2f us  max %.2f us\n", name, p50, p90, p99, p999, max);
+}
+
+// Stand-in for a node: counts every ArtDmx packet and timestamps the ones
+// for the first universe so inter-packet jitter can be measured.
+struct Receiver {
+	ArtNetSocket socket;
+	std::atomic<bool> stop{ false };
+	std::atomic<bool> recording{ false };
+	std::atomic<uint64_t> packets{ 0 };
+	uint16_t tracked_universe = 0;
+	std::vector<Clock::time_point> arrivals;
+
+	void run() {
+		uint8_t packet[1024];
+		while (!stop.load(std::memory_order_relaxed)) {
+			ArtNetAddress from;
+			int size = socket.receive(packet, sizeof(packet), from, 50);
+			if (!recording.load(std::memory_order_relaxed) || size < static_cast<int>(ARTNET_DMX_HEADER_SIZE) || artnet_read_opcode(packet, static_cast<size_t>(size)) != ARTNET_OP_DMX) {
+				continue;
+			}
+			packets.fetch_add(1, std::memory_order_relaxed);
+			uint16_t port_address = static_cast<uint16_t>(packet[14] | ((packet[15] & 0x7F) << 8));
+			if (port_address == tracked_universe && arrivals.size() < arrivals.capacity()) {
+				arrivals.push_back(Clock::now());
+			}
+		}
+	}
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+	Options options;
+	if (!parse_options(argc, argv, options)) {
+		std::fprintf(stderr, "usage: %s [--universes N] [--rate HZ] [--seconds S] [--mode sync|thread] [--delta] [--static] [--port PORT] [--shards N]\n", argv[0]);
+		return 2;
+	}
+
+	Receiver receiver;
+	ArtNetAddress receive_address;
+	if (!ArtNetAddress::parse("127.0.0.1", options.port, receive_address) || !receiver.socket.open(receive_address)) {
+		std::fprintf(stderr, "failed to open receiver on 127.0.0.1:%u\n", options.port);
+		return 1;
+	}
+
+	// Extra shards are further sockets on the same loopback address.
+	ArtNetOutput output;
+	std::vector<std::string> shard_addresses(static_cast<size_t>(options.shards - 1), "127.0.0.1");
+	if (!output.configure("127.0.0.1", static_cast<uint16_t>(options.port + 1), "127.0.0.1", options.port) || !output.configure_shards(shard_addresses, {}, {}) || !output.open()) {
+		std::fprintf(stderr, "failed to open output on 127.0.0.1:%u\n", options.port + 1);
+		return 1;
+	}
+	output.set_enabled(true);
+	output.set_delta_enabled(options.delta);
+
+	const size_t frames = static_cast<size_t>(std::ceil(options.seconds * options.rate));
+	const size_t universes = static_cast<size_t>(options.universes);
+	const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate));
+
+	std::vector<uint8_t> data(DMX_UNIVERSE_SIZE);
+	std::vector<double> set_latency;
+	std::vector<double> send_latency;
+	set_latency.reserve(frames * universes);
+	send_latency.reserve(frames);
+	receiver.arrivals.reserve(frames * 2 + 16);
+
+	if (options.threaded && !output.start_sender(options.rate, false)) {
+		std::fprintf(stderr, "failed to start sender thread\n");
+		return 1;
+	}
+	std::thread receive_thread(&Receiver::run, &receiver);
+
+	// Warm-up: creates every universe buffer and lets scratch lists on both
+	// threads reach their final size before anything is measured.
+	for (int frame = 0; frame < 5; frame++) {
+		for (size_t u = 0; u < universes; u++) {
+			output.set_universe_data(static_cast<uint16_t>(u), data.data(), data.size());
+		}
+		output.send_all();
+		std::this_thread::sleep_for(period);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	output.reset_counters();
+	receiver.recording = true;
+
+	const uint64_t allocations_before = allocation_count.load();
+	const double cpu_before = cpu_seconds();
+	const Clock::time_point start = Clock::now();
+	Clock::time_point deadline = start;
+
+	for (size_t frame = 0; frame < frames; frame++) {
+		if (!options.static_data) {
+			std::fill(data.begin(), data.end(), static_cast<uint8_t>(frame));
+		}
+		for (size_t u = 0; u < universes; u++) {
+			Clock::time_point before = Clock::now();
+			output.set_universe_data(static_cast<uint16_t>(u), data.data(), data.size());
+			set_latency.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+		}
+		Clock::time_point before = Clock::now();
+		output.send_all();
+		send_latency.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+
+		deadline += period;
+		std::this_thread::sleep_until(deadline);
+	}
+
+	const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	const double cpu = cpu_seconds() - cpu_before;
+	const uint64_t allocations = allocation_count.load() - allocations_before;
+
+	output.stop_sender();
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	receiver.stop = true;
+	receive_thread.join();
+
+	const uint64_t sent = output.get_packets_sent();
+	const uint64_t received = receiver.packets.load();
+
+	std::printf("artnet_bench: %zu universes @ %.1f Hz for %.1f s, mode=%s, delta=%s, data=%s, shards=%d\n", universes, options.rate, elapsed,
+			options.threaded ? "thread" : "sync", options.delta ? "on" : "off", options.static_data ? "static" : "changing", options.shards);
+	std::printf("%-18s %zu\n", "frames", frames);
+	std::printf("%-18s %llu (%.0f/s), skipped %llu\n", "packets sent", static_cast<unsigned long long>(sent), sent / elapsed,
+			static_cast<unsigned long long>(output.get_packets_skipped()));
+	std::printf("%-18s %llu (loss %.2f%%)\n", "packets received", static_cast<unsigned long long>(received),
+			sent ? 100.0 * (1.0 - static_cast<double>(received) / static_cast<double>(sent)) : 0.0);
+	print_latency("set_dmx_data", set_latency);
+	print_latency("send_dmx", send_latency);
+	std::printf("%-18s %.3f s (%.1f%% of one core)\n", "cpu time", cpu, 100.0 * cpu / elapsed);
+	std::printf("%-18s %.2f\n", "allocations/frame", static_cast<double>(allocations) / static_cast<double>(frames));
+
+	std::vector<double> intervals;
+	for (size_t i = 1; i < receiver.arrivals.size(); i++) {
+		intervals.push_back(std::chrono::duration<double, std::milli>(receiver.arrivals[i] - receiver.arrivals[i - 1]).count());
+	}
+	if (intervals.empty()) {
+		std::printf("%-18s no packets for universe 0\n", "jitter");
+		return 0;
+	}
+	double mean = 0.0;
+	for (double interval : intervals) {
+		mean += interval;
+	}
+	mean /= intervals.size();
+	double variance = 0.0;
+	std::vector<double> deviation;
+	const double expected = 1000.0 / options.rate;
+	for (double interval : intervals) {
+		variance += (interval - mean) * (interval - mean);
+		deviation.push_back(std::fabs(interval - expected));
+	}
+	double stddev = std::sqrt(variance / intervals.size());
+	double p99 = percentile(deviation, 0.99);
+	double max = *std::max_element(deviation.begin(), deviation.end());
+	std::printf("%-18s interval mean %.3f ms (expected %.3f), stddev %.3f ms, p99 |dev| %.3f ms, max |dev| %.3f ms\n", "jitter (u0)",
+			mean, expected, stddev, p99, max);
+	return 0;
+}
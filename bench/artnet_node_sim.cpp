@@ -0,0 +1,180 @@
+// Headless Art-Net node simulator. Listens like a node would (on loopback by
+// default) so a show or artnet_bench can be load tested without hardware,
+// and reports per-universe packet rate, sequence gaps, reordering and, with
+// --probe, latency measured from stamps the sender writes into its frames.
+//
+//   artnet_node_sim [--bind ADDRESS] [--port PORT] [--first UNIVERSE] [--universes N]
+//                   [--seconds S] [--interval S] [--probe CHANNEL]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "artnet_node_simulator.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::atomic<bool> interrupted{ false };
+
+void handle_interrupt(int) {
+	interrupted = true;
+}
+
+struct Options {
+	std::string bind = "127.0.0.1";
+	uint16_t port = ARTNET_DEFAULT_PORT;
+	int first = 0;
+	int universes = 64;
+	double seconds = 0.0; // 0 runs until interrupted
+	double interval = 1.0;
+	int probe = -1;
+};
+
+bool parse_options(int argc, char **argv, Options &r_options) {
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+		if (arg == "--bind" && has_value) {
+			r_options.bind = argv[++i];
+		} else if (arg == "--port" && has_value) {
+			r_options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+		} else if (arg == "--first" && has_value) {
+			r_options.first = std::clamp(std::atoi(argv[++i]), 0, static_cast<int>(ARTNET_MAX_PORT_ADDRESS));
+		} else if (arg == "--universes" && has_value) {
+			r_options.universes = std::clamp(std::atoi(argv[++i]), 1, static_cast<int>(ARTNET_MAX_PORT_ADDRESS) + 1);
+		} else if (arg == "--seconds" && has_value) {
+			r_options.seconds = std::max(std::atof(argv[++i]), 0.0);
+		} else if (arg == "--interval" && has_value) {
+			r_options.interval = std::max(std::atof(argv[++i]), 0.1);
+		} else if (arg == "--probe" && has_value) {
+			r_options.probe = std::atoi(argv[++i]);
+		} else {
+			return false;
+		}
+	}
+	return r_options.port != 0;
+}
+
+struct Totals {
+	uint64_t packets = 0;
+	uint64_t lost = 0;
+	uint64_t out_of_order = 0;
+	uint64_t duplicates = 0;
+	double latency_total = 0.0;
+	uint64_t latency_universes = 0;
+	double latency_max = -1.0;
+};
+
+Totals sum(const ArtNetNodeSimulator &simulator) {
+	Totals totals;
+	for (const DmxSimulatedUniverse *universe : simulator.get_universes()) {
+		DmxSimulatedUniverseStats stats;
+		ArtNetNodeSimulator::read_stats(*universe, stats);
+		totals.packets += stats.packets;
+		totals.lost += stats.lost;
+		totals.out_of_order += stats.out_of_order;
+		totals.duplicates += stats.duplicates;
+		if (stats.latency_avg_usec >= 0.0) {
+			totals.latency_total += stats.latency_avg_usec;
+			totals.latency_universes++;
+			totals.latency_max = std::max(totals.latency_max, stats.latency_max_usec);
+		}
+	}
+	return totals;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+	Options options;
+	if (!parse_options(argc, argv, options)) {
+		std::fprintf(stderr, "usage: %s [--bind ADDRESS] [--port PORT] [--first UNIVERSE] [--universes N] [--seconds S] [--interval S] [--probe CHANNEL]\n", argv[0]);
+		return 2;
+	}
+
+	ArtNetNodeSimulator simulator;
+	int last = std::min(options.first + options.universes - 1, static_cast<int>(ARTNET_MAX_PORT_ADDRESS));
+	for (int universe = options.first; universe <= last; universe++) {
+		simulator.listen(static_cast<uint16_t>(universe));
+	}
+	if (!simulator.set_latency_stamp_channel(options.probe)) {
+		std::fprintf(stderr, "--probe must be -1 or a channel from 0 to %zu\n", DMX_UNIVERSE_SIZE - ARTNET_LATENCY_STAMP_SIZE);
+		return 2;
+	}
+	ArtNetAddress bind;
+	if (!ArtNetAddress::parse(options.bind, options.port, bind) || !simulator.start(bind)) {
+		std::fprintf(stderr, "failed to listen on %s:%u\n", options.bind.c_str(), options.port);
+		return 1;
+	}
+	std::signal(SIGINT, handle_interrupt);
+	std::signal(SIGTERM, handle_interrupt);
+
+	std::printf("artnet_node_sim: universes %d-%d on %s:%u\n", options.first, last, options.bind.c_str(), options.port);
+	const Clock::time_point start = Clock::now();
+	const Clock::duration report_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.interval));
+	Clock::time_point next_report = start + report_period;
+	Totals previous;
+
+	while (!interrupted.load()) {
+		Clock::time_point now = Clock::now();
+		double elapsed = std::chrono::duration<double>(now - start).count();
+		if (options.seconds > 0.0 && elapsed >= options.seconds) {
+			break;
+		}
+		if (now >= next_report) {
+			Totals totals = sum(simulator);
+			double period = std::chrono::duration<double>(report_period).count();
+			std::printf("%8.1f s  %8.0f packets/s  lost %llu  out of order %llu  duplicates %llu", elapsed, (totals.packets - previous.packets) / period,
+					static_cast<unsigned long long>(totals.lost - previous.lost), static_cast<unsigned long long>(totals.out_of_order - previous.out_of_order),
+					static_cast<unsigned long long>(totals.duplicates - previous.duplicates));
+			if (totals.latency_universes > 0) {
+				std::printf("  latency avg %.1f us max %.1f us", totals.latency_total / totals.latency_universes, totals.latency_max);
+			}
+			std::printf("\n");
+			std::fflush(stdout);
+			previous = totals;
+			next_report += report_period;
+		}
+		std::this_thread::sleep_until(std::min(next_report, now + std::chrono::milliseconds(100)));
+	}
+	const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	simulator.stop();
+
+	// Summary: totals, then only the universes that saw problems or no traffic.
+	Totals totals = sum(simulator);
+	std::printf("\n%-18s %.1f s\n", "duration", elapsed);
+	std::printf("%-18s %llu (%.0f/s)\n", "packets", static_cast<unsigned long long>(totals.packets), elapsed > 0.0 ? totals.packets / elapsed : 0.0);
+	std::printf("%-18s %llu\n", "ignored", static_cast<unsigned long long>(simulator.get_packets_ignored()));
+	std::printf("%-18s %llu\n", "syncs", static_cast<unsigned long long>(simulator.get_syncs_received()));
+	std::printf("%-18s lost %llu, out of order %llu, duplicates %llu\n", "sequence", static_cast<unsigned long long>(totals.lost),
+			static_cast<unsigned long long>(totals.out_of_order), static_cast<unsigned long long>(totals.duplicates));
+	size_t silent = 0;
+	for (const DmxSimulatedUniverse *universe : simulator.get_universes()) {
+		DmxSimulatedUniverseStats stats;
+		ArtNetNodeSimulator::read_stats(*universe, stats);
+		if (stats.packets == 0) {
+			silent++;
+			continue;
+		}
+		if (stats.lost == 0 && stats.out_of_order == 0 && stats.duplicates == 0) {
+			continue;
+		}
+		std::printf("  universe %-6u %8llu packets  %6.1f Hz  lost %llu  out of order %llu  duplicates %llu\n", universe->port_address,
+				static_cast<unsigned long long>(stats.packets), stats.rate_hz, static_cast<unsigned long long>(stats.lost),
+				static_cast<unsigned long long>(stats.out_of_order), static_cast<unsigned long long>(stats.duplicates));
+	}
+	if (silent > 0) {
+		std::printf("%-18s %zu universes received nothing\n", "silent", silent);
+	}
+	if (totals.latency_universes > 0) {
+		std::printf("%-18s avg %.1f us, max %.1f us\n", "latency", totals.latency_total / totals.latency_universes, totals.latency_max);
+	}
+	return 0;
+}
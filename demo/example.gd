@@ -18,7 +18,7 @@ func _ready() -> void:
 	
 	# Configure ArtNet controller
 	# Parameters: bind_address, port, net, subnet, universe, broadcast_address
-	if not artnet.configure(BIND_ADDRESS, 6454, 0, 0, UNIVERSE, BROADCAST_ADDRESS):
+	if not artnet.configure(BIND_ADDRESS, 6454, 0, 0, 0, BROADCAST_ADDRESS):
 		print("Failed to configure ArtNet controller")
 		return
 	
@@ -14,14 +14,13 @@ const BROADCAST_ADDRESS = "192.168.15.255"  # Your network's broadcast address
 
 # Timing
 const COLOR_CHANGE_INTERVAL = 2.0  # Change colors every 2 seconds
-const DMX_SEND_INTERVAL = 0.01  # Send DMX every 10ms
+const DMX_REFRESH_RATE = 44.0  # Sender thread output rate in Hz
 
 var artnet: ArtNetController
 var orbs: Array[MeshInstance3D] = []
 var target_colors: Array[Color] = []
 var current_colors: Array[Color] = []
 var time_since_color_change: float = 0.0
-var time_since_dmx_send: float = 0.0
 var dmx_error_printed: bool = false
 
 func _ready() -> void:
@@ -29,7 +28,7 @@ func _ready() -> void:
 	artnet = ArtNetController.new()
 	
 	# Configure ArtNet controller
-	if not artnet.configure(BIND_ADDRESS, 6454, 0, 0, UNIVERSE, BROADCAST_ADDRESS):
+	if not artnet.configure(BIND_ADDRESS, 6454, 0, 0, 0, BROADCAST_ADDRESS):
 		print("Failed to configure ArtNet controller")
 		return
 	
@@ -38,6 +37,12 @@ func _ready() -> void:
 		print("Failed to start ArtNet controller")
 		return
 	
+	# Packets are sent by the controller's own thread at a fixed rate, so output
+	# timing does not depend on the game's frame rate
+	if not artnet.start_sender(DMX_REFRESH_RATE):
+		print("Failed to start ArtNet sender thread")
+		return
+	
 	print("ArtNet controller started successfully")
 	print("Sending DMX data for ", ORBS_COUNT, " orbs (", TOTAL_DMX_CHANNELS, " channels) on universe ", UNIVERSE)
 	
@@ -118,7 +123,6 @@ func _process(delta: float) -> void:
 		return
 	
 	time_since_color_change += delta
-	time_since_dmx_send += delta
 	
 	# Change target colors every 2 seconds
 	if time_since_color_change >= COLOR_CHANGE_INTERVAL:
@@ -132,44 +136,23 @@ func _process(delta: float) -> void:
 		current_colors[i] = current_colors[i].lerp(target_colors[i], lerp_speed * delta)
 		_update_orb_color(i, current_colors[i])
 	
-	# Send DMX data every 10ms
-	if time_since_dmx_send >= DMX_SEND_INTERVAL:
-		time_since_dmx_send = 0.0
-		_send_dmx_data()
+	# Commit this frame's colors; the sender thread transmits them on its next tick
+	_send_dmx_data()
 
 func _send_dmx_data() -> void:
-	# Create DMX data array (full 512 channel universe)
-	# Some ArtNet devices expect full universe, so we'll pad unused channels to 0
-	var dmx_data: PackedByteArray
-	dmx_data.resize(512)  # Full universe
-	dmx_data.fill(0)  # Initialize all channels to 0
-	
-	# Map each orb's RGB color to DMX channels
-	for i in range(ORBS_COUNT):
-		var color = current_colors[i]
-		var base_channel = i * CHANNELS_PER_ORB
-		
-		# Convert color values (0.0-1.0) to DMX values (0-255)
-		# DMX channels are 1-indexed in the protocol, but array is 0-indexed
-		# Channel 1 = Red, Channel 2 = Green, Channel 3 = Blue
-		dmx_data[base_channel + 0] = int(color.r * 255)  # Red
-		dmx_data[base_channel + 1] = int(color.g * 255)  # Green
-		dmx_data[base_channel + 2] = int(color.b * 255)  # Blue
-	
-	# Set DMX data for the configured universe
-	if artnet.set_dmx_data(UNIVERSE, dmx_data):
-		# Send the DMX data
-		if artnet.send_dmx():
-			# Success - reset error flag if it was set
-			dmx_error_printed = false
-		else:
-			# Only print error once to avoid spam
-			if not dmx_error_printed:
-				print("Warning: Failed to send DMX data (this is normal if no ArtNet hardware is connected)")
-				dmx_error_printed = true
+	# Colors are packed into the universe buffer natively: one RGB fixture
+	# (3 channels) per orb, starting at channel 1. The buffer is a full 512
+	# channel universe and unused channels stay at 0.
+	artnet.pack_colors(UNIVERSE, PackedColorArray(current_colors), ArtNetController.COLOR_LAYOUT_RGB)
+	
+	# Commit the DMX data for the sender thread
+	if artnet.send_dmx():
+		# Success - reset error flag if it was set
+		dmx_error_printed = false
 	else:
+		# Only print error once to avoid spam
 		if not dmx_error_printed:
-			print("Warning: Failed to set DMX data")
+			print("Warning: Failed to send DMX data (this is normal if no ArtNet hardware is connected)")
 			dmx_error_printed = true
 
 func _exit_tree() -> void:
@@ -1,94 +1,848 @@
 #include "artnet_controller.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/main_loop.hpp>
+#include <godot_cpp/classes/time.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
-#include "../lib-artnet-4-cpp/artnet/logging.h"
+
+#include "dmx_recording.h"
 
 using namespace godot;
 
+namespace {
+
+String format_address(const ArtNetAddress &address) {
+	const uint8_t *octets = reinterpret_cast<const uint8_t *>(&address.ip);
+	return String::num_int64(octets[0]) + "." + String::num_int64(octets[1]) + "." + String::num_int64(octets[2]) + "." + String::num_int64(octets[3]);
+}
+
+Dictionary node_to_dictionary(const ArtNetNode &node, std::chrono::steady_clock::time_point now) {
+	Dictionary entry;
+	entry["ip"] = format_address(node.address);
+	entry["bind_index"] = node.bind_index;
+	entry["short_name"] = String::utf8(node.short_name);
+	entry["long_name"] = String::utf8(node.long_name);
+	String mac;
+	for (size_t i = 0; i < sizeof(node.mac); i++) {
+		mac += (i > 0 ? ":" : "") + String::num_int64(node.mac[i], 16).lpad(2, "0");
+	}
+	entry["mac"] = mac;
+	entry["oem"] = node.oem;
+	entry["esta_manufacturer"] = node.esta_manufacturer;
+	entry["firmware_version"] = node.firmware_version;
+	entry["status1"] = node.status1;
+	entry["status2"] = node.status2;
+	PackedInt32Array outputs;
+	PackedInt32Array inputs;
+	for (size_t i = 0; i < node.port_count; i++) {
+		if (node.is_output(i)) {
+			outputs.push_back(node.output_ports[i]);
+		}
+		if (node.is_input(i)) {
+			inputs.push_back(node.input_ports[i]);
+		}
+	}
+	entry["output_universes"] = outputs;
+	entry["input_universes"] = inputs;
+	entry["age"] = std::chrono::duration<double>(now - node.last_seen).count();
+	return entry;
+}
+
+} // namespace
+
 void ArtNetController::_bind_methods() {
-	ClassDB::bind_method(D_METHOD("configure", "bind_address", "port", "net", "subnet", "universe", "broadcast_address"), &ArtNetController::configure, DEFVAL("255.255.255.255"));
+	ClassDB::bind_method(D_METHOD("configure", "bind_address", "port", "net", "subnet", "universe", "broadcast_address"), &ArtNetController::configure, DEFVAL(0), DEFVAL(0), DEFVAL(0), DEFVAL("255.255.255.255"));
 	ClassDB::bind_method(D_METHOD("start"), &ArtNetController::start);
 	ClassDB::bind_method(D_METHOD("stop"), &ArtNetController::stop);
 	ClassDB::bind_method(D_METHOD("is_running"), &ArtNetController::is_running);
 	ClassDB::bind_method(D_METHOD("set_enable_sending_dmx", "enable"), &ArtNetController::set_enable_sending_dmx);
 	ClassDB::bind_method(D_METHOD("set_dmx_data", "universe", "data"), &ArtNetController::set_dmx_data);
+	ClassDB::bind_method(D_METHOD("get_universe", "universe"), &ArtNetController::get_universe);
 	ClassDB::bind_method(D_METHOD("send_dmx"), &ArtNetController::send_dmx);
+	ClassDB::bind_method(D_METHOD("send_dmx_batch", "first_universe", "data"), &ArtNetController::send_dmx_batch);
+	ClassDB::bind_method(D_METHOD("send_dmx_batch_list", "universes", "data"), &ArtNetController::send_dmx_batch_list);
+	ClassDB::bind_method(D_METHOD("create_layer", "priority", "mode"), &ArtNetController::create_layer, DEFVAL(0), DEFVAL(DmxLayer::MODE_HTP));
+	ClassDB::bind_method(D_METHOD("remove_layer", "layer"), &ArtNetController::remove_layer);
+	ClassDB::bind_method(D_METHOD("get_layer_count"), &ArtNetController::get_layer_count);
+	ClassDB::bind_method(D_METHOD("pack_colors", "universe", "colors", "layout", "start_channel", "stride"), &ArtNetController::pack_colors, DEFVAL(COLOR_LAYOUT_RGB), DEFVAL(0), DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("pack_values", "universe", "values", "layout", "start_channel", "stride"), &ArtNetController::pack_values, DEFVAL(COLOR_LAYOUT_RGB), DEFVAL(0), DEFVAL(0));
+	ClassDB::bind_method(D_METHOD("set_color_gamma", "gamma"), &ArtNetController::set_color_gamma);
+	ClassDB::bind_method(D_METHOD("get_color_gamma"), &ArtNetController::get_color_gamma);
+	ClassDB::bind_method(D_METHOD("set_master_dimmer", "dimmer"), &ArtNetController::set_master_dimmer);
+	ClassDB::bind_method(D_METHOD("get_master_dimmer"), &ArtNetController::get_master_dimmer);
+	ClassDB::bind_method(D_METHOD("start_sender", "rate_hz", "realtime_priority"), &ArtNetController::start_sender, DEFVAL(44.0), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("stop_sender"), &ArtNetController::stop_sender);
+	ClassDB::bind_method(D_METHOD("is_sender_running"), &ArtNetController::is_sender_running);
+	ClassDB::bind_method(D_METHOD("set_keep_alive_interval", "seconds"), &ArtNetController::set_keep_alive_interval);
+	ClassDB::bind_method(D_METHOD("get_keep_alive_interval"), &ArtNetController::get_keep_alive_interval);
+	ClassDB::bind_method(D_METHOD("configure_shards", "bind_addresses", "broadcast_addresses", "cpus"), &ArtNetController::configure_shards, DEFVAL(PackedStringArray()), DEFVAL(PackedInt32Array()));
+	ClassDB::bind_method(D_METHOD("get_shard_count"), &ArtNetController::get_shard_count);
+	ClassDB::bind_method(D_METHOD("get_universe_shard", "universe"), &ArtNetController::get_universe_shard);
+	ClassDB::bind_method(D_METHOD("get_shard_stats"), &ArtNetController::get_shard_stats);
+	ClassDB::bind_method(D_METHOD("schedule_dmx", "universe", "data", "time_usec"), &ArtNetController::schedule_dmx);
+	ClassDB::bind_method(D_METHOD("schedule_dmx_batch", "first_universe", "data", "time_usec"), &ArtNetController::schedule_dmx_batch);
+	ClassDB::bind_method(D_METHOD("clear_schedule"), &ArtNetController::clear_schedule);
+	ClassDB::bind_method(D_METHOD("get_scheduled_frame_count"), &ArtNetController::get_scheduled_frame_count);
+	ClassDB::bind_method(D_METHOD("set_schedule_capacity", "frames"), &ArtNetController::set_schedule_capacity);
+	ClassDB::bind_method(D_METHOD("get_schedule_capacity"), &ArtNetController::get_schedule_capacity);
+	ClassDB::bind_method(D_METHOD("set_late_frame_policy", "policy"), &ArtNetController::set_late_frame_policy);
+	ClassDB::bind_method(D_METHOD("get_late_frame_policy"), &ArtNetController::get_late_frame_policy);
+	ClassDB::bind_method(D_METHOD("set_late_frame_tolerance", "seconds"), &ArtNetController::set_late_frame_tolerance);
+	ClassDB::bind_method(D_METHOD("get_late_frame_tolerance"), &ArtNetController::get_late_frame_tolerance);
+	ClassDB::bind_method(D_METHOD("get_scheduled_frames_sent"), &ArtNetController::get_scheduled_frames_sent);
+	ClassDB::bind_method(D_METHOD("get_scheduled_frames_dropped"), &ArtNetController::get_scheduled_frames_dropped);
+	ClassDB::bind_method(D_METHOD("get_scheduled_frames_late"), &ArtNetController::get_scheduled_frames_late);
+	ClassDB::bind_method(D_METHOD("get_schedule_timing_error_usec"), &ArtNetController::get_schedule_timing_error_usec);
+	ClassDB::bind_method(D_METHOD("get_schedule_max_timing_error_usec"), &ArtNetController::get_schedule_max_timing_error_usec);
+	ClassDB::bind_method(D_METHOD("fade_channels", "universe", "channel", "values", "duration", "curve"), &ArtNetController::fade_channels, DEFVAL(FADE_LINEAR));
+	ClassDB::bind_method(D_METHOD("fade_channel_range", "universe", "channel", "count", "value", "duration", "curve"), &ArtNetController::fade_channel_range, DEFVAL(FADE_LINEAR));
+	ClassDB::bind_method(D_METHOD("release_fades", "universe", "channel", "count"), &ArtNetController::release_fades, DEFVAL(0), DEFVAL(512));
+	ClassDB::bind_method(D_METHOD("release_all_fades"), &ArtNetController::release_all_fades);
+	ClassDB::bind_method(D_METHOD("get_running_fade_count"), &ArtNetController::get_running_fade_count);
+	ClassDB::bind_method(D_METHOD("set_delta_transmission", "enable"), &ArtNetController::set_delta_transmission);
+	ClassDB::bind_method(D_METHOD("is_delta_transmission_enabled"), &ArtNetController::is_delta_transmission_enabled);
+	ClassDB::bind_method(D_METHOD("get_packets_sent"), &ArtNetController::get_packets_sent);
+	ClassDB::bind_method(D_METHOD("get_packets_skipped"), &ArtNetController::get_packets_skipped);
+	ClassDB::bind_method(D_METHOD("reset_packet_counters"), &ArtNetController::reset_packet_counters);
+	ClassDB::bind_method(D_METHOD("get_universe_send_age", "universe"), &ArtNetController::get_universe_send_age);
+	ClassDB::bind_method(D_METHOD("set_art_sync_enabled", "enable"), &ArtNetController::set_art_sync_enabled);
+	ClassDB::bind_method(D_METHOD("is_art_sync_enabled"), &ArtNetController::is_art_sync_enabled);
+	ClassDB::bind_method(D_METHOD("get_art_syncs_sent"), &ArtNetController::get_art_syncs_sent);
+	ClassDB::bind_method(D_METHOD("start_discovery", "poll_interval"), &ArtNetController::start_discovery, DEFVAL(3.0));
+	ClassDB::bind_method(D_METHOD("stop_discovery"), &ArtNetController::stop_discovery);
+	ClassDB::bind_method(D_METHOD("is_discovery_running"), &ArtNetController::is_discovery_running);
+	ClassDB::bind_method(D_METHOD("set_send_mode", "mode"), &ArtNetController::set_send_mode);
+	ClassDB::bind_method(D_METHOD("get_send_mode"), &ArtNetController::get_send_mode);
+	ClassDB::bind_method(D_METHOD("get_unicast_routes"), &ArtNetController::get_unicast_routes);
+	ClassDB::bind_method(D_METHOD("poll_nodes"), &ArtNetController::poll_nodes);
+	ClassDB::bind_method(D_METHOD("get_nodes"), &ArtNetController::get_nodes);
+	ClassDB::bind_method(D_METHOD("get_universe_nodes", "universe"), &ArtNetController::get_universe_nodes);
+	ClassDB::bind_method(D_METHOD("get_node_count"), &ArtNetController::get_node_count);
+	ClassDB::bind_method(D_METHOD("configure_sacn", "source_name", "universe_offset", "bind_address"), &ArtNetController::configure_sacn, DEFVAL("Godot Art-Net"), DEFVAL(1), DEFVAL("0.0.0.0"));
+	ClassDB::bind_method(D_METHOD("start_sacn"), &ArtNetController::start_sacn);
+	ClassDB::bind_method(D_METHOD("stop_sacn"), &ArtNetController::stop_sacn);
+	ClassDB::bind_method(D_METHOD("is_sacn_running"), &ArtNetController::is_sacn_running);
+	ClassDB::bind_method(D_METHOD("set_sacn_priority", "priority"), &ArtNetController::set_sacn_priority);
+	ClassDB::bind_method(D_METHOD("get_sacn_priority"), &ArtNetController::get_sacn_priority);
+	ClassDB::bind_method(D_METHOD("set_sacn_sync_universe", "universe"), &ArtNetController::set_sacn_sync_universe);
+	ClassDB::bind_method(D_METHOD("get_sacn_sync_universe"), &ArtNetController::get_sacn_sync_universe);
+	ClassDB::bind_method(D_METHOD("get_sacn_packets_sent"), &ArtNetController::get_sacn_packets_sent);
+	ClassDB::bind_method(D_METHOD("set_artnet_output_enabled", "enable"), &ArtNetController::set_artnet_output_enabled);
+	ClassDB::bind_method(D_METHOD("is_artnet_output_enabled"), &ArtNetController::is_artnet_output_enabled);
+	ClassDB::bind_method(D_METHOD("start_receiving", "universes"), &ArtNetController::start_receiving);
+	ClassDB::bind_method(D_METHOD("stop_receiving"), &ArtNetController::stop_receiving);
+	ClassDB::bind_method(D_METHOD("is_receiving"), &ArtNetController::is_receiving);
+	ClassDB::bind_method(D_METHOD("poll_dmx"), &ArtNetController::poll_dmx);
+	ClassDB::bind_method(D_METHOD("get_received_dmx", "universe"), &ArtNetController::get_received_dmx);
+	ClassDB::bind_method(D_METHOD("set_merge_mode", "mode"), &ArtNetController::set_merge_mode);
+	ClassDB::bind_method(D_METHOD("get_merge_mode"), &ArtNetController::get_merge_mode);
+	ClassDB::bind_method(D_METHOD("get_packets_received"), &ArtNetController::get_packets_received);
 	ClassDB::bind_method(D_METHOD("set_log_level", "level"), &ArtNetController::set_log_level);
+	ClassDB::bind_method(D_METHOD("get_log_level"), &ArtNetController::get_log_level);
+
+	ADD_SIGNAL(MethodInfo("dmx_received", PropertyInfo(Variant::INT, "universe"), PropertyInfo(Variant::PACKED_BYTE_ARRAY, "data")));
+	ADD_SIGNAL(MethodInfo("node_added", PropertyInfo(Variant::DICTIONARY, "node")));
+	ADD_SIGNAL(MethodInfo("node_changed", PropertyInfo(Variant::DICTIONARY, "node")));
+	ADD_SIGNAL(MethodInfo("node_lost", PropertyInfo(Variant::DICTIONARY, "node")));
+
+	BIND_ENUM_CONSTANT(SEND_MODE_BROADCAST);
+	BIND_ENUM_CONSTANT(SEND_MODE_UNICAST);
+
+	BIND_ENUM_CONSTANT(MERGE_MODE_HTP);
+	BIND_ENUM_CONSTANT(MERGE_MODE_LTP);
+
+	BIND_ENUM_CONSTANT(COLOR_LAYOUT_RGB);
+	BIND_ENUM_CONSTANT(COLOR_LAYOUT_GRB);
+	BIND_ENUM_CONSTANT(COLOR_LAYOUT_BGR);
+	BIND_ENUM_CONSTANT(COLOR_LAYOUT_RGBW);
+	BIND_ENUM_CONSTANT(COLOR_LAYOUT_RGB16);
+	BIND_ENUM_CONSTANT(COLOR_LAYOUT_RGBW16);
+	BIND_ENUM_CONSTANT(COLOR_LAYOUT_DIMMER);
+
+	BIND_ENUM_CONSTANT(LATE_FRAME_DROP);
+	BIND_ENUM_CONSTANT(LATE_FRAME_SEND_NOW);
+
+	BIND_ENUM_CONSTANT(FADE_LINEAR);
+	BIND_ENUM_CONSTANT(FADE_EASE_IN);
+	BIND_ENUM_CONSTANT(FADE_EASE_OUT);
+	BIND_ENUM_CONSTANT(FADE_EASE_IN_OUT);
 }
 
 ArtNetController::ArtNetController() {
-	controller = new ArtNet::ArtNetController();
+	output.set_layer_stack(&layers);
 }
 
 ArtNetController::~ArtNetController() {
-	if (controller) {
-		controller->stop();
-		delete controller;
-		controller = nullptr;
-	}
+	stop_receiving();
+	stop_node_polling();
+	output.close();
 }
 
 bool ArtNetController::configure(const String &bind_address, int port, int net, int subnet, int universe, const String &broadcast_address) {
-	if (!controller) {
+	if (output.is_open()) {
+		return false;
+	}
+	if (port <= 0 || port > 65535 || net < 0 || net > 127 || subnet < 0 || subnet > 15 || universe < 0 || universe > 15) {
 		return false;
 	}
+	// Kept for compatibility only: every DMX method takes a full Port-Address.
+	if (net != 0 || subnet != 0 || universe != 0) {
+		UtilityFunctions::push_warning("ArtNetController: the net, subnet and universe arguments of configure() are deprecated and ignored. Pass the full Port-Address (net * 256 + subnet * 16 + universe) as the universe of each DMX method.");
+	}
 
 	std::string bind_addr = std::string(bind_address.utf8().get_data());
 	std::string broadcast_addr = std::string(broadcast_address.utf8().get_data());
 
-	return controller->configure(bind_addr, port, static_cast<uint8_t>(net), static_cast<uint8_t>(subnet), static_cast<uint8_t>(universe), broadcast_addr);
+	return output.configure(bind_addr, static_cast<uint16_t>(port), broadcast_addr);
 }
 
 bool ArtNetController::start() {
-	if (!controller) {
+	if (output.is_open()) {
+		return true;
+	}
+	if (!output.open()) {
 		return false;
 	}
-	return controller->start();
+	output.set_enabled(true);
+	return true;
 }
 
 void ArtNetController::stop() {
-	if (controller) {
-		controller->stop();
-	}
+	stop_receiving();
+	stop_discovery();
+	output.close();
 }
 
 bool ArtNetController::is_running() const {
-	if (!controller) {
+	return output.is_open();
+}
+
+void ArtNetController::set_enable_sending_dmx(bool enable) {
+	output.set_enabled(enable);
+}
+
+bool ArtNetController::set_dmx_data(int universe, const PackedByteArray &data) {
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
 		return false;
 	}
-	return controller->isRunning();
+	return output.set_universe_data(static_cast<uint16_t>(universe), data.ptr(), static_cast<size_t>(data.size()));
 }
 
-void ArtNetController::set_enable_sending_dmx(bool enable) {
-	if (controller) {
-		controller->setEnableSendingDMX(enable);
+Ref<DmxUniverse> ArtNetController::get_universe(int universe) {
+	Ref<DmxUniverse> handle;
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
+		return handle;
+	}
+	DmxUniverseBuffer *buffer = output.get_universe(static_cast<uint16_t>(universe));
+	if (!buffer) {
+		return handle;
 	}
+	handle.instantiate();
+	handle->setup(Ref<RefCounted>(this), buffer);
+	return handle;
 }
 
-bool ArtNetController::set_dmx_data(int universe, const PackedByteArray &data) {
-	if (!controller) {
+bool ArtNetController::send_dmx() {
+	// The output merges the layers over their universes as it sends.
+	return output.send_all();
+}
+
+bool ArtNetController::send_dmx_batch(int first_universe, const PackedByteArray &data) {
+	if (first_universe < 0 || first_universe > ARTNET_MAX_PORT_ADDRESS) {
 		return false;
 	}
+	return output.send_universe_range(static_cast<uint16_t>(first_universe), data.ptr(), static_cast<size_t>(data.size()));
+}
+
+bool ArtNetController::send_dmx_batch_list(const PackedInt32Array &universes, const PackedByteArray &data) {
+	return output.send_universe_list(universes.ptr(), static_cast<size_t>(universes.size()), data.ptr(), static_cast<size_t>(data.size()));
+}
+
+Ref<DmxLayer> ArtNetController::create_layer(int priority, DmxLayer::Mode mode) {
+	std::shared_ptr<DmxMergeLayer> layer = layers.create_layer(priority, static_cast<DmxLayerMode>(mode));
+	if (!layer) {
+		return Ref<DmxLayer>();
+	}
+	Ref<DmxLayer> handle;
+	handle.instantiate();
+	handle->setup(Ref<RefCounted>(this), layer);
+	return handle;
+}
 
-	// Convert PackedByteArray to std::vector<uint8_t>
-	std::vector<uint8_t> dmx_data;
-	dmx_data.reserve(data.size());
-	for (int i = 0; i < data.size(); i++) {
-		dmx_data.push_back(data[i]);
+bool ArtNetController::remove_layer(const Ref<DmxLayer> &layer) {
+	if (layer.is_null()) {
+		return false;
 	}
+	return layers.remove_layer(layer->get_layer());
+}
 
-	return controller->setDmxData(static_cast<uint16_t>(universe), dmx_data);
+int ArtNetController::get_layer_count() const {
+	return static_cast<int>(layers.get_layer_count());
 }
 
-bool ArtNetController::send_dmx() {
-	if (!controller) {
+bool ArtNetController::make_pack_layout(int universe, ColorLayout layout, int start_channel, int stride, DmxPackLayout &r_layout) const {
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || layout < 0 || static_cast<int>(layout) >= DMX_LAYOUT_MAX) {
+		return false;
+	}
+	if (start_channel < 0 || start_channel >= static_cast<int>(DMX_UNIVERSE_SIZE) || stride < 0) {
+		return false;
+	}
+	r_layout.layout = static_cast<DmxColorLayout>(layout);
+	r_layout.start_channel = static_cast<size_t>(start_channel);
+	r_layout.stride = static_cast<size_t>(stride);
+	return true;
+}
+
+int ArtNetController::pack_colors(int universe, const PackedColorArray &colors, ColorLayout layout, int start_channel, int stride) {
+	DmxPackLayout pack_layout;
+	if (!make_pack_layout(universe, layout, start_channel, stride, pack_layout)) {
+		return 0;
+	}
+	DmxUniverseBuffer *buffer = output.get_universe(static_cast<uint16_t>(universe));
+	if (!buffer) {
+		return 0;
+	}
+	// Color is four packed floats (r, g, b, a).
+	const float *rgba = reinterpret_cast<const float *>(colors.ptr());
+	size_t packed = dmx_pack_colors(buffer->data, rgba, static_cast<size_t>(colors.size()), pack_layout, color_curve);
+	size_t end = dmx_pack_end(pack_layout, packed);
+	if (end > buffer->length) {
+		buffer->length = artnet_dmx_length(end);
+	}
+	return static_cast<int>(packed);
+}
+
+int ArtNetController::pack_values(int universe, const PackedFloat32Array &values, ColorLayout layout, int start_channel, int stride) {
+	DmxPackLayout pack_layout;
+	if (!make_pack_layout(universe, layout, start_channel, stride, pack_layout)) {
+		return 0;
+	}
+	DmxUniverseBuffer *buffer = output.get_universe(static_cast<uint16_t>(universe));
+	if (!buffer) {
+		return 0;
+	}
+	size_t count = static_cast<size_t>(values.size()) / dmx_layout_components(pack_layout.layout);
+	size_t packed = dmx_pack_values(buffer->data, values.ptr(), count, pack_layout, color_curve);
+	size_t end = dmx_pack_end(pack_layout, packed);
+	if (end > buffer->length) {
+		buffer->length = artnet_dmx_length(end);
+	}
+	return static_cast<int>(packed);
+}
+
+void ArtNetController::set_color_gamma(float gamma) {
+	color_curve.set_gamma(gamma);
+}
+
+float ArtNetController::get_color_gamma() const {
+	return color_curve.get_gamma();
+}
+
+void ArtNetController::set_master_dimmer(float dimmer) {
+	color_curve.set_dimmer(dimmer);
+}
+
+float ArtNetController::get_master_dimmer() const {
+	return color_curve.get_dimmer();
+}
+
+bool ArtNetController::start_sender(double rate_hz, bool realtime_priority) {
+	return output.start_sender(rate_hz, realtime_priority);
+}
+
+void ArtNetController::stop_sender() {
+	output.stop_sender();
+}
+
+bool ArtNetController::is_sender_running() {
+	return output.is_sender_running();
+}
+
+void ArtNetController::set_keep_alive_interval(double seconds) {
+	output.set_keep_alive_interval(seconds);
+}
+
+double ArtNetController::get_keep_alive_interval() const {
+	return output.get_keep_alive_interval();
+}
+
+bool ArtNetController::configure_shards(const PackedStringArray &bind_addresses, const PackedStringArray &broadcast_addresses, const PackedInt32Array &cpus) {
+	std::vector<std::string> binds;
+	for (int64_t i = 0; i < bind_addresses.size(); i++) {
+		binds.push_back(std::string(bind_addresses[i].utf8().get_data()));
+	}
+	std::vector<std::string> broadcasts;
+	for (int64_t i = 0; i < broadcast_addresses.size(); i++) {
+		broadcasts.push_back(std::string(broadcast_addresses[i].utf8().get_data()));
+	}
+	std::vector<int> cpu_list(cpus.ptr(), cpus.ptr() + cpus.size());
+	return output.configure_shards(binds, broadcasts, cpu_list);
+}
+
+int ArtNetController::get_shard_count() const {
+	return static_cast<int>(output.get_shard_count());
+}
+
+int ArtNetController::get_universe_shard(int universe) const {
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
+		return -1;
+	}
+	return static_cast<int>(output.get_universe_shard(static_cast<uint16_t>(universe)));
+}
+
+Array ArtNetController::get_shard_stats() const {
+	Array shards;
+	for (size_t i = 0; i < output.get_shard_count(); i++) {
+		ArtNetShardStats stats = output.get_shard_stats(i);
+		Dictionary shard;
+		shard["bind_address"] = format_address(stats.bind_address);
+		shard["broadcast_address"] = format_address(stats.destination);
+		shard["cpu"] = stats.cpu;
+		shard["pinned"] = stats.pinned;
+		shard["universes"] = static_cast<int64_t>(stats.universes);
+		shard["packets_sent"] = static_cast<int64_t>(stats.packets_sent);
+		shard["bytes_sent"] = static_cast<int64_t>(stats.bytes_sent);
+		shard["send_errors"] = static_cast<int64_t>(stats.send_errors);
+		shard["average_send_usec"] = stats.average_send_usec;
+		shard["max_send_usec"] = stats.max_send_usec;
+		shards.push_back(shard);
+	}
+	return shards;
+}
+
+int64_t ArtNetController::to_output_clock(int64_t time_usec) {
+	// Both are monotonic clocks ticking at the same rate, so the offset is
+	// stable; taking it on every call keeps it right across suspend/resume.
+	int64_t offset = ArtNetOutput::get_clock_usec() - static_cast<int64_t>(Time::get_singleton()->get_ticks_usec());
+	return time_usec + offset;
+}
+
+bool ArtNetController::schedule_dmx(int universe, const PackedByteArray &data, int64_t time_usec) {
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
+		return false;
+	}
+	return output.schedule_universe(static_cast<uint16_t>(universe), data.ptr(), static_cast<size_t>(data.size()), to_output_clock(time_usec));
+}
+
+bool ArtNetController::schedule_dmx_batch(int first_universe, const PackedByteArray &data, int64_t time_usec) {
+	if (first_universe < 0 || first_universe > ARTNET_MAX_PORT_ADDRESS) {
+		return false;
+	}
+	return output.schedule_universe_range(static_cast<uint16_t>(first_universe), data.ptr(), static_cast<size_t>(data.size()), to_output_clock(time_usec));
+}
+
+void ArtNetController::clear_schedule() {
+	output.clear_schedule();
+}
+
+int ArtNetController::get_scheduled_frame_count() const {
+	return static_cast<int>(output.get_scheduled_count());
+}
+
+bool ArtNetController::set_schedule_capacity(int frames) {
+	if (frames <= 0) {
+		return false;
+	}
+	return output.set_schedule_capacity(static_cast<size_t>(frames));
+}
+
+int ArtNetController::get_schedule_capacity() const {
+	return static_cast<int>(output.get_schedule_capacity());
+}
+
+void ArtNetController::set_late_frame_policy(LateFramePolicy policy) {
+	output.set_late_frame_policy(static_cast<ArtNetOutput::LateFramePolicy>(policy));
+}
+
+ArtNetController::LateFramePolicy ArtNetController::get_late_frame_policy() const {
+	return static_cast<LateFramePolicy>(output.get_late_frame_policy());
+}
+
+void ArtNetController::set_late_frame_tolerance(double seconds) {
+	output.set_late_frame_tolerance(seconds);
+}
+
+double ArtNetController::get_late_frame_tolerance() const {
+	return output.get_late_frame_tolerance();
+}
+
+int64_t ArtNetController::get_scheduled_frames_sent() const {
+	return static_cast<int64_t>(output.get_scheduled_frames_sent());
+}
+
+int64_t ArtNetController::get_scheduled_frames_dropped() const {
+	return static_cast<int64_t>(output.get_scheduled_frames_dropped());
+}
+
+int64_t ArtNetController::get_scheduled_frames_late() const {
+	return static_cast<int64_t>(output.get_scheduled_frames_late());
+}
+
+double ArtNetController::get_schedule_timing_error_usec() const {
+	return output.get_average_timing_error_usec();
+}
+
+double ArtNetController::get_schedule_max_timing_error_usec() const {
+	return output.get_max_timing_error_usec();
+}
+
+bool ArtNetController::fade_channels(int universe, int channel, const PackedByteArray &values, double duration, FadeCurve curve) {
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE)) {
+		return false;
+	}
+	return output.fade_channels(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), values.ptr(), static_cast<size_t>(values.size()), duration, static_cast<DmxFadeCurve>(curve));
+}
+
+bool ArtNetController::fade_channel_range(int universe, int channel, int count, int value, double duration, FadeCurve curve) {
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE) || count <= 0 || value < 0 || value > 255) {
+		return false;
+	}
+	return output.fade_channel_range(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), static_cast<size_t>(count), static_cast<uint8_t>(value), duration, static_cast<DmxFadeCurve>(curve));
+}
+
+bool ArtNetController::release_fades(int universe, int channel, int count) {
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE) || count <= 0) {
+		return false;
+	}
+	// Clamp so the default count releases everything from channel on.
+	size_t available = DMX_UNIVERSE_SIZE - static_cast<size_t>(channel);
+	return output.release_fades(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), std::min(static_cast<size_t>(count), available));
+}
+
+bool ArtNetController::release_all_fades() {
+	return output.release_all_fades();
+}
+
+int ArtNetController::get_running_fade_count() const {
+	return static_cast<int>(output.get_running_fade_count());
+}
+
+void ArtNetController::set_delta_transmission(bool enable) {
+	output.set_delta_enabled(enable);
+}
+
+bool ArtNetController::is_delta_transmission_enabled() const {
+	return output.is_delta_enabled();
+}
+
+int64_t ArtNetController::get_packets_sent() const {
+	return static_cast<int64_t>(output.get_packets_sent());
+}
+
+int64_t ArtNetController::get_packets_skipped() const {
+	return static_cast<int64_t>(output.get_packets_skipped());
+}
+
+void ArtNetController::reset_packet_counters() {
+	output.reset_counters();
+}
+
+double ArtNetController::get_universe_send_age(int universe) const {
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
+		return -1.0;
+	}
+	return output.get_send_age(static_cast<uint16_t>(universe));
+}
+
+void ArtNetController::set_art_sync_enabled(bool enable) {
+	output.set_art_sync_enabled(enable);
+}
+
+bool ArtNetController::is_art_sync_enabled() const {
+	return output.is_art_sync_enabled();
+}
+
+int64_t ArtNetController::get_art_syncs_sent() const {
+	return static_cast<int64_t>(output.get_syncs_sent());
+}
+
+bool ArtNetController::start_discovery(double poll_interval) {
+	if (!output.start_discovery(poll_interval)) {
+		return false;
+	}
+	// Node changes are delivered once per frame, like received DMX.
+	MainLoop *main_loop = Engine::get_singleton()->get_main_loop();
+	if (main_loop && main_loop->has_signal("process_frame")) {
+		main_loop->connect("process_frame", callable_mp(this, &ArtNetController::poll_nodes));
+	}
+	return true;
+}
+
+void ArtNetController::stop_discovery() {
+	if (!output.is_discovery_running()) {
+		return;
+	}
+	output.stop_discovery();
+	// The tables may be shared with another controller that keeps polling,
+	// so report every node this one knew about as lost.
+	std::vector<std::shared_ptr<const ArtNetNodeTable>> known = std::move(node_tables);
+	stop_node_polling();
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	for (const std::shared_ptr<const ArtNetNodeTable> &table : known) {
+		for (const ArtNetNode &node : table->nodes) {
+			emit_signal("node_lost", node_to_dictionary(node, now));
+		}
+	}
+}
+
+void ArtNetController::stop_node_polling() {
+	MainLoop *main_loop = Engine::get_singleton()->get_main_loop();
+	Callable poll = callable_mp(this, &ArtNetController::poll_nodes);
+	if (main_loop && main_loop->is_connected("process_frame", poll)) {
+		main_loop->disconnect("process_frame", poll);
+	}
+	node_tables.clear();
+}
+
+bool ArtNetController::is_discovery_running() const {
+	return output.is_discovery_running();
+}
+
+void ArtNetController::set_send_mode(SendMode mode) {
+	output.set_send_mode(static_cast<ArtNetOutput::SendMode>(mode));
+}
+
+ArtNetController::SendMode ArtNetController::get_send_mode() const {
+	return static_cast<SendMode>(output.get_send_mode());
+}
+
+Dictionary ArtNetController::get_unicast_routes() const {
+	Dictionary routes;
+	// Each shard sends with the routes discovered on its own address.
+	for (size_t shard = 0; shard < output.get_shard_count(); shard++) {
+		std::shared_ptr<const ArtNetRoutingTable> table = output.get_routing_table(shard);
+		for (const auto &entry : table->routes) {
+			if (output.get_universe_shard(entry.first) != shard) {
+				continue;
+			}
+			PackedStringArray nodes;
+			for (const ArtNetAddress &address : entry.second) {
+				nodes.push_back(format_address(address));
+			}
+			routes[entry.first] = nodes;
+		}
+	}
+	return routes;
+}
+
+int ArtNetController::poll_nodes() {
+	if (!output.is_discovery_running()) {
+		return 0;
+	}
+	std::vector<std::shared_ptr<const ArtNetNodeTable>> tables = output.get_node_tables();
+	const ArtNetNodeTable empty;
+	std::vector<ArtNetNodeTable::Change> changes;
+	for (size_t i = 0; i < std::max(tables.size(), node_tables.size()); i++) {
+		const ArtNetNodeTable &before = i < node_tables.size() ? *node_tables[i] : empty;
+		const ArtNetNodeTable &after = i < tables.size() ? *tables[i] : empty;
+		// Tables are only republished on change, so an unchanged pointer means nothing to do.
+		if (&before != &after) {
+			ArtNetNodeTable::diff(before, after, changes);
+		}
+	}
+	if (changes.empty()) {
+		node_tables = std::move(tables);
+		return 0;
+	}
+	// The old tables stay alive until the signals are out, since lost nodes point into them.
+	std::vector<std::shared_ptr<const ArtNetNodeTable>> previous = std::move(node_tables);
+	node_tables = std::move(tables);
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	static const char *const signals[] = { "node_added", "node_changed", "node_lost" };
+	for (const ArtNetNodeTable::Change &change : changes) {
+		emit_signal(signals[change.type], node_to_dictionary(*change.node, now));
+	}
+	return static_cast<int>(changes.size());
+}
+
+Array ArtNetController::get_nodes() const {
+	Array nodes;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	for (const std::shared_ptr<const ArtNetNodeTable> &table : output.get_node_tables()) {
+		for (const ArtNetNode &node : table->nodes) {
+			nodes.push_back(node_to_dictionary(node, now));
+		}
+	}
+	return nodes;
+}
+
+Array ArtNetController::get_universe_nodes(int universe) const {
+	Array nodes;
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
+		return nodes;
+	}
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	for (const std::shared_ptr<const ArtNetNodeTable> &table : output.get_node_tables()) {
+		const std::vector<uint32_t> *indices = table->find(static_cast<uint16_t>(universe));
+		if (!indices) {
+			continue;
+		}
+		for (uint32_t index : *indices) {
+			nodes.push_back(node_to_dictionary(table->nodes[index], now));
+		}
+	}
+	return nodes;
+}
+
+int ArtNetController::get_node_count() const {
+	size_t count = 0;
+	for (const std::shared_ptr<const ArtNetNodeTable> &table : output.get_node_tables()) {
+		count += table->nodes.size();
+	}
+	return static_cast<int>(count);
+}
+
+bool ArtNetController::configure_sacn(const String &source_name, int universe_offset, const String &bind_address) {
+	if (universe_offset < -ARTNET_MAX_PORT_ADDRESS || universe_offset > SACN_MAX_UNIVERSE) {
 		return false;
 	}
-	return controller->sendDmx();
+	return output.configure_sacn(std::string(bind_address.utf8().get_data()), std::string(source_name.utf8().get_data()), universe_offset);
+}
+
+bool ArtNetController::start_sacn() {
+	return output.start_sacn();
+}
+
+void ArtNetController::stop_sacn() {
+	output.stop_sacn();
+}
+
+bool ArtNetController::is_sacn_running() const {
+	return output.is_sacn_running();
+}
+
+void ArtNetController::set_sacn_priority(int priority) {
+	output.get_sacn().set_priority(priority);
+}
+
+int ArtNetController::get_sacn_priority() const {
+	return output.get_sacn().get_priority();
+}
+
+void ArtNetController::set_sacn_sync_universe(int universe) {
+	output.get_sacn().set_sync_universe(universe);
+}
+
+int ArtNetController::get_sacn_sync_universe() const {
+	return output.get_sacn().get_sync_universe();
+}
+
+int64_t ArtNetController::get_sacn_packets_sent() const {
+	return static_cast<int64_t>(output.get_sacn().get_packets_sent());
+}
+
+void ArtNetController::set_artnet_output_enabled(bool enable) {
+	output.set_artnet_enabled(enable);
+}
+
+bool ArtNetController::is_artnet_output_enabled() const {
+	return output.is_artnet_enabled();
+}
+
+bool ArtNetController::start_receiving(const PackedInt32Array &universes) {
+	if (!output.is_open() || input.is_running() || universes.is_empty()) {
+		return false;
+	}
+	input.clear();
+	for (int64_t i = 0; i < universes.size(); i++) {
+		if (universes[i] < 0 || universes[i] > ARTNET_MAX_PORT_ADDRESS || !input.listen(static_cast<uint16_t>(universes[i]))) {
+			input.clear();
+			return false;
+		}
+	}
+	if (!input.start(output.get_endpoint())) {
+		return false;
+	}
+
+	// Deliver received frames once per frame, so a packet flood never turns
+	// into more than one signal per universe per frame.
+	MainLoop *main_loop = Engine::get_singleton()->get_main_loop();
+	if (main_loop && main_loop->has_signal("process_frame")) {
+		main_loop->connect("process_frame", callable_mp(this, &ArtNetController::poll_dmx));
+	}
+	return true;
+}
+
+void ArtNetController::stop_receiving() {
+	if (!input.is_running()) {
+		return;
+	}
+	MainLoop *main_loop = Engine::get_singleton()->get_main_loop();
+	Callable poll = callable_mp(this, &ArtNetController::poll_dmx);
+	if (main_loop && main_loop->is_connected("process_frame", poll)) {
+		main_loop->disconnect("process_frame", poll);
+	}
+	input.stop();
+}
+
+bool ArtNetController::is_receiving() const {
+	return input.is_running();
+}
+
+int ArtNetController::poll_dmx() {
+	if (!input.take_pending()) {
+		return 0;
+	}
+	DmxRecordingWriter *recorder = output.is_recording_received() ? output.get_recorder() : nullptr;
+	if (recorder) {
+		recorder->begin_frame(ArtNetOutput::get_clock_usec());
+	}
+	int updated = 0;
+	for (DmxInputUniverse *universe : input.get_universes()) {
+		if (!universe->index.acquire()) {
+			continue;
+		}
+		updated++;
+		if (recorder) {
+			uint8_t front = universe->index.front();
+			recorder->add_universe(static_cast<uint16_t>(universe->port_address | DMX_RECORDING_RECEIVED), universe->frames[front], universe->frame_length[front]);
+		}
+		emit_signal("dmx_received", universe->port_address, get_received_dmx(universe->port_address));
+	}
+	if (recorder) {
+		recorder->end_frame();
+	}
+	return updated;
+}
+
+PackedByteArray ArtNetController::get_received_dmx(int universe) const {
+	PackedByteArray data;
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
+		return data;
+	}
+	const DmxInputUniverse *buffer = input.find_universe(static_cast<uint16_t>(universe));
+	if (!buffer) {
+		return data;
+	}
+	uint8_t front = buffer->index.front();
+	data.resize(buffer->frame_length[front]);
+	if (buffer->frame_length[front] > 0) {
+		std::memcpy(data.ptrw(), buffer->frames[front], buffer->frame_length[front]);
+	}
+	return data;
+}
+
+void ArtNetController::set_merge_mode(MergeMode mode) {
+	input.set_merge_mode(static_cast<ArtNetInput::MergeMode>(mode));
+}
+
+ArtNetController::MergeMode ArtNetController::get_merge_mode() const {
+	return static_cast<MergeMode>(input.get_merge_mode());
+}
+
+int64_t ArtNetController::get_packets_received() const {
+	return static_cast<int64_t>(input.get_packets_received());
 }
 
 void ArtNetController::set_log_level(int level) {
-	ArtNet::Logger::setLevel(static_cast<ArtNet::LogLevel>(level));
+	ArtNetLog::get_singleton().set_level(static_cast<ArtNetLogLevel>(std::clamp(level, static_cast<int>(ARTNET_LOG_NONE), static_cast<int>(ARTNET_LOG_DEBUG))));
 }
 
+int ArtNetController::get_log_level() const {
+	return ArtNetLog::get_singleton().get_level();
+}
@@ -2,29 +2,84 @@
 
 #include "godot_cpp/classes/ref_counted.hpp"
 #include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/array.hpp"
 #include "godot_cpp/variant/variant.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
 #include "godot_cpp/variant/packed_byte_array.hpp"
+#include "godot_cpp/variant/packed_color_array.hpp"
+#include "godot_cpp/variant/packed_float32_array.hpp"
+#include "godot_cpp/variant/packed_int32_array.hpp"
+#include "godot_cpp/variant/packed_string_array.hpp"
 #include "godot_cpp/variant/string.hpp"
 
-#include "../lib-artnet-4-cpp/artnet/ArtNetController.h"
+#include "artnet_input.h"
+#include "artnet_log.h"
+#include "artnet_output.h"
+#include "dmx_layer.h"
+#include "dmx_layer_stack.h"
+#include "dmx_pack.h"
+#include "dmx_universe.h"
 
 using namespace godot;
 
 class ArtNetController : public RefCounted {
 	GDCLASS(ArtNetController, RefCounted)
 
+public:
+	enum SendMode {
+		SEND_MODE_BROADCAST = ArtNetOutput::SEND_MODE_BROADCAST,
+		SEND_MODE_UNICAST = ArtNetOutput::SEND_MODE_UNICAST,
+	};
+
+	enum MergeMode {
+		MERGE_MODE_HTP = ArtNetInput::MERGE_MODE_HTP,
+		MERGE_MODE_LTP = ArtNetInput::MERGE_MODE_LTP,
+	};
+
+	enum ColorLayout {
+		COLOR_LAYOUT_RGB = DMX_LAYOUT_RGB,
+		COLOR_LAYOUT_GRB = DMX_LAYOUT_GRB,
+		COLOR_LAYOUT_BGR = DMX_LAYOUT_BGR,
+		COLOR_LAYOUT_RGBW = DMX_LAYOUT_RGBW,
+		COLOR_LAYOUT_RGB16 = DMX_LAYOUT_RGB16,
+		COLOR_LAYOUT_RGBW16 = DMX_LAYOUT_RGBW16,
+		COLOR_LAYOUT_DIMMER = DMX_LAYOUT_DIMMER,
+	};
+
+	enum LateFramePolicy {
+		LATE_FRAME_DROP = ArtNetOutput::LATE_FRAME_DROP,
+		LATE_FRAME_SEND_NOW = ArtNetOutput::LATE_FRAME_SEND_NOW,
+	};
+
+	enum FadeCurve {
+		FADE_LINEAR = DMX_FADE_LINEAR,
+		FADE_EASE_IN = DMX_FADE_EASE_IN,
+		FADE_EASE_OUT = DMX_FADE_EASE_OUT,
+		FADE_EASE_IN_OUT = DMX_FADE_EASE_IN_OUT,
+	};
+
 protected:
 	static void _bind_methods();
 
 private:
-	ArtNet::ArtNetController *controller;
+	ArtNetOutput output;
+	DmxColorCurve color_curve;
+	ArtNetInput input;
+	DmxLayerStack layers;
+	// Node tables as of the last node signals, one per discovery address.
+	std::vector<std::shared_ptr<const ArtNetNodeTable>> node_tables;
+
+	// Converts a Time.get_ticks_usec() timestamp to the output's clock.
+	static int64_t to_output_clock(int64_t time_usec);
+	bool make_pack_layout(int universe, ColorLayout layout, int start_channel, int stride, DmxPackLayout &r_layout) const;
+	void stop_node_polling();
 
 public:
 	ArtNetController();
 	~ArtNetController() override;
 
 	// Configuration
-	bool configure(const String &bind_address, int port, int net, int subnet, int universe, const String &broadcast_address = "255.255.255.255");
+	bool configure(const String &bind_address, int port, int net = 0, int subnet = 0, int universe = 0, const String &broadcast_address = "255.255.255.255");
 
 	// Network Control
 	bool start();
@@ -34,9 +89,120 @@ public:
 	// DMX Operations
 	void set_enable_sending_dmx(bool enable);
 	bool set_dmx_data(int universe, const PackedByteArray &data);
+	Ref<DmxUniverse> get_universe(int universe);
 	bool send_dmx();
-	
+	bool send_dmx_batch(int first_universe, const PackedByteArray &data);
+	bool send_dmx_batch_list(const PackedInt32Array &universes, const PackedByteArray &data);
+
+	// Layers
+	Ref<DmxLayer> create_layer(int priority = 0, DmxLayer::Mode mode = DmxLayer::MODE_HTP);
+	bool remove_layer(const Ref<DmxLayer> &layer);
+	int get_layer_count() const;
+
+	// Color Packing
+	int pack_colors(int universe, const PackedColorArray &colors, ColorLayout layout = COLOR_LAYOUT_RGB, int start_channel = 0, int stride = 0);
+	int pack_values(int universe, const PackedFloat32Array &values, ColorLayout layout = COLOR_LAYOUT_RGB, int start_channel = 0, int stride = 0);
+	void set_color_gamma(float gamma);
+	float get_color_gamma() const;
+	void set_master_dimmer(float dimmer);
+	float get_master_dimmer() const;
+
+	// Sender Thread
+	bool start_sender(double rate_hz = 44.0, bool realtime_priority = false);
+	void stop_sender();
+	bool is_sender_running();
+	void set_keep_alive_interval(double seconds);
+	double get_keep_alive_interval() const;
+
+	// Send Sharding
+	bool configure_shards(const PackedStringArray &bind_addresses, const PackedStringArray &broadcast_addresses = PackedStringArray(), const PackedInt32Array &cpus = PackedInt32Array());
+	int get_shard_count() const;
+	int get_universe_shard(int universe) const;
+	Array get_shard_stats() const;
+
+	// Scheduled Playout
+	bool schedule_dmx(int universe, const PackedByteArray &data, int64_t time_usec);
+	bool schedule_dmx_batch(int first_universe, const PackedByteArray &data, int64_t time_usec);
+	void clear_schedule();
+	int get_scheduled_frame_count() const;
+	bool set_schedule_capacity(int frames);
+	int get_schedule_capacity() const;
+	void set_late_frame_policy(LateFramePolicy policy);
+	LateFramePolicy get_late_frame_policy() const;
+	void set_late_frame_tolerance(double seconds);
+	double get_late_frame_tolerance() const;
+	int64_t get_scheduled_frames_sent() const;
+	int64_t get_scheduled_frames_dropped() const;
+	int64_t get_scheduled_frames_late() const;
+	double get_schedule_timing_error_usec() const;
+	double get_schedule_max_timing_error_usec() const;
+
+	// Fades
+	bool fade_channels(int universe, int channel, const PackedByteArray &values, double duration, FadeCurve curve = FADE_LINEAR);
+	bool fade_channel_range(int universe, int channel, int count, int value, double duration, FadeCurve curve = FADE_LINEAR);
+	bool release_fades(int universe, int channel = 0, int count = 512);
+	bool release_all_fades();
+	int get_running_fade_count() const;
+
+	// Delta Transmission
+	void set_delta_transmission(bool enable);
+	bool is_delta_transmission_enabled() const;
+	int64_t get_packets_sent() const;
+	int64_t get_packets_skipped() const;
+	void reset_packet_counters();
+	double get_universe_send_age(int universe) const;
+
+	// ArtSync
+	void set_art_sync_enabled(bool enable);
+	bool is_art_sync_enabled() const;
+	int64_t get_art_syncs_sent() const;
+
+	// Discovery
+	bool start_discovery(double poll_interval = 3.0);
+	void stop_discovery();
+	bool is_discovery_running() const;
+	void set_send_mode(SendMode mode);
+	SendMode get_send_mode() const;
+	Dictionary get_unicast_routes() const;
+	int poll_nodes();
+	Array get_nodes() const;
+	Array get_universe_nodes(int universe) const;
+	int get_node_count() const;
+
+	// sACN (E1.31)
+	bool configure_sacn(const String &source_name = "Godot Art-Net", int universe_offset = 1, const String &bind_address = "0.0.0.0");
+	bool start_sacn();
+	void stop_sacn();
+	bool is_sacn_running() const;
+	void set_sacn_priority(int priority);
+	int get_sacn_priority() const;
+	void set_sacn_sync_universe(int universe);
+	int get_sacn_sync_universe() const;
+	int64_t get_sacn_packets_sent() const;
+	void set_artnet_output_enabled(bool enable);
+	bool is_artnet_output_enabled() const;
+
+	// Receiving
+	bool start_receiving(const PackedInt32Array &universes);
+	void stop_receiving();
+	bool is_receiving() const;
+	int poll_dmx();
+	PackedByteArray get_received_dmx(int universe) const;
+	void set_merge_mode(MergeMode mode);
+	MergeMode get_merge_mode() const;
+	int64_t get_packets_received() const;
+
 	// Debugging
 	void set_log_level(int level); // 0=NONE, 1=ERROR, 2=INFO, 3=DEBUG
+	int get_log_level() const;
+
+	// Native access for helpers such as DmxPixelMapper.
+	ArtNetOutput &get_output() { return output; }
+	const DmxColorCurve &get_color_curve() const { return color_curve; }
 };
 
+VARIANT_ENUM_CAST(ArtNetController::SendMode);
+VARIANT_ENUM_CAST(ArtNetController::MergeMode);
+VARIANT_ENUM_CAST(ArtNetController::ColorLayout);
+VARIANT_ENUM_CAST(ArtNetController::LateFramePolicy);
+VARIANT_ENUM_CAST(ArtNetController::FadeCurve);
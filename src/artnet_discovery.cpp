@@ -0,0 +1,187 @@
+#include "artnet_discovery.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "artnet_log.h"
+#include "artnet_protocol.h"
+
+namespace {
+
+void copy_name(char *dst, const uint8_t *src, size_t size) {
+	std::memcpy(dst, src, size - 1);
+	dst[size - 1] = 0;
+}
+
+bool same_routes(const ArtNetNode &a, const ArtNetNode &b) {
+	for (size_t i = 0; i < 4; i++) {
+		if (a.is_output(i) != b.is_output(i) || (a.is_output(i) && a.output_ports[i] != b.output_ports[i])) {
+			return false;
+		}
+	}
+	return a.address.ip == b.address.ip;
+}
+
+} // namespace
+
+bool ArtNetNode::same_state(const ArtNetNode &other) const {
+	return address.ip == other.address.ip && address.port == other.address.port && bind_index == other.bind_index && status1 == other.status1 && status2 == other.status2 && port_count == other.port_count && oem == other.oem && esta_manufacturer == other.esta_manufacturer && firmware_version == other.firmware_version && std::memcmp(mac, other.mac, sizeof(mac)) == 0 && std::strcmp(short_name, other.short_name) == 0 && std::strcmp(long_name, other.long_name) == 0 && std::memcmp(port_types, other.port_types, sizeof(port_types)) == 0 && std::memcmp(good_input, other.good_input, sizeof(good_input)) == 0 && std::memcmp(good_output, other.good_output, sizeof(good_output)) == 0 && std::memcmp(input_ports, other.input_ports, sizeof(input_ports)) == 0 && std::memcmp(output_ports, other.output_ports, sizeof(output_ports)) == 0;
+}
+
+void ArtNetNodeTable::diff(const ArtNetNodeTable &before, const ArtNetNodeTable &after, std::vector<Change> &r_changes) {
+	auto key = [](const ArtNetNode &node) {
+		return std::make_pair(node.address.ip, node.bind_index);
+	};
+	size_t i = 0;
+	size_t j = 0;
+	while (i < before.nodes.size() || j < after.nodes.size()) {
+		if (j == after.nodes.size() || (i < before.nodes.size() && key(before.nodes[i]) < key(after.nodes[j]))) {
+			r_changes.push_back({ NODE_LOST, &before.nodes[i++] });
+		} else if (i == before.nodes.size() || key(after.nodes[j]) < key(before.nodes[i])) {
+			r_changes.push_back({ NODE_ADDED, &after.nodes[j++] });
+		} else {
+			if (before.nodes[i].revision != after.nodes[j].revision) {
+				r_changes.push_back({ NODE_CHANGED, &after.nodes[j] });
+			}
+			i++;
+			j++;
+		}
+	}
+}
+
+bool ArtNetDiscovery::handle_poll_reply(const uint8_t *data, size_t size, const ArtNetAddress &from, std::chrono::steady_clock::time_point now) {
+	if (size < ARTNET_POLL_REPLY_MIN_SIZE || artnet_read_opcode(data, size) != ARTNET_OP_POLL_REPLY) {
+		return false;
+	}
+
+	ArtNetNode node;
+	std::memcpy(&node.address.ip, data + ARTNET_POLL_REPLY_IP, sizeof(node.address.ip));
+	if (node.address.ip == 0) {
+		node.address.ip = from.ip;
+	}
+	node.address.port = ARTNET_DEFAULT_PORT;
+	node.last_seen = now;
+	// Replies from before Art-Net 3 end at the MAC address.
+	node.bind_index = size > ARTNET_POLL_REPLY_BIND_INDEX ? data[ARTNET_POLL_REPLY_BIND_INDEX] : 0;
+	node.status2 = size > ARTNET_POLL_REPLY_STATUS2 ? data[ARTNET_POLL_REPLY_STATUS2] : 0;
+	node.status1 = data[ARTNET_POLL_REPLY_STATUS1];
+	node.oem = static_cast<uint16_t>((data[ARTNET_POLL_REPLY_OEM] << 8) | data[ARTNET_POLL_REPLY_OEM + 1]);
+	node.esta_manufacturer = static_cast<uint16_t>(data[ARTNET_POLL_REPLY_ESTA_MAN] | (data[ARTNET_POLL_REPLY_ESTA_MAN + 1] << 8));
+	node.firmware_version = static_cast<uint16_t>((data[ARTNET_POLL_REPLY_VERSION_INFO] << 8) | data[ARTNET_POLL_REPLY_VERSION_INFO + 1]);
+	std::memcpy(node.mac, data + ARTNET_POLL_REPLY_MAC, sizeof(node.mac));
+	copy_name(node.short_name, data + ARTNET_POLL_REPLY_SHORT_NAME, sizeof(node.short_name));
+	copy_name(node.long_name, data + ARTNET_POLL_REPLY_LONG_NAME, sizeof(node.long_name));
+
+	uint8_t net = data[ARTNET_POLL_REPLY_NET_SWITCH];
+	uint8_t subnet = data[ARTNET_POLL_REPLY_SUB_SWITCH];
+	node.port_count = static_cast<uint8_t>(std::min<size_t>(data[ARTNET_POLL_REPLY_NUM_PORTS], 4));
+	for (size_t i = 0; i < node.port_count; i++) {
+		node.port_types[i] = data[ARTNET_POLL_REPLY_PORT_TYPES + i];
+		node.good_input[i] = data[ARTNET_POLL_REPLY_GOOD_INPUT + i];
+		node.good_output[i] = data[ARTNET_POLL_REPLY_GOOD_OUTPUT + i];
+		node.input_ports[i] = artnet_port_address(net, subnet, data[ARTNET_POLL_REPLY_SW_IN + i]);
+		node.output_ports[i] = artnet_port_address(net, subnet, data[ARTNET_POLL_REPLY_SW_OUT + i]);
+	}
+
+	auto key = std::make_pair(node.address.ip, node.bind_index);
+	auto it = nodes.find(key);
+	if (it != nodes.end() && it->second.same_state(node)) {
+		it->second.last_seen = now;
+		seen = true;
+		return true;
+	}
+	bool routes_changed = it == nodes.end() || !same_routes(it->second, node);
+	const uint8_t *ip = reinterpret_cast<const uint8_t *>(&node.address.ip);
+	if (it == nodes.end()) {
+		ArtNetLog::get_singleton().write(ARTNET_LOG_INFO, "discovered node %lld.%lld.%lld.%lld (bind index %lld) with %lld ports", ip[0], ip[1], ip[2], ip[3], key.second, static_cast<long long>(node.port_count));
+	} else {
+		node.revision = it->second.revision + 1;
+		ArtNetLog::get_singleton().write(ARTNET_LOG_INFO, "node %lld.%lld.%lld.%lld (bind index %lld) changed its configuration", ip[0], ip[1], ip[2], ip[3], key.second);
+	}
+	nodes[key] = node;
+	publish_nodes();
+	if (routes_changed) {
+		publish_routes();
+	}
+	return true;
+}
+
+void ArtNetDiscovery::expire(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration timeout) {
+	bool changed = false;
+	for (auto it = nodes.begin(); it != nodes.end();) {
+		if (now - it->second.last_seen > timeout) {
+			const uint8_t *ip = reinterpret_cast<const uint8_t *>(&it->second.address.ip);
+			ArtNetLog::get_singleton().write(ARTNET_LOG_INFO, "node %lld.%lld.%lld.%lld (bind index %lld) stopped replying", ip[0], ip[1], ip[2], ip[3], it->first.second);
+			it = nodes.erase(it);
+			changed = true;
+		} else {
+			++it;
+		}
+	}
+	if (changed) {
+		publish_routes();
+	}
+	// Runs once per poll, which bounds how stale last-seen times get.
+	if (changed || seen) {
+		publish_nodes();
+	}
+}
+
+void ArtNetDiscovery::clear() {
+	nodes.clear();
+	publish_routes();
+	publish_nodes();
+}
+
+void ArtNetDiscovery::publish_routes() {
+	std::shared_ptr<ArtNetRoutingTable> table = std::make_shared<ArtNetRoutingTable>();
+	for (const auto &entry : nodes) {
+		const ArtNetNode &node = entry.second;
+		for (size_t i = 0; i < node.port_count; i++) {
+			if (!node.is_output(i)) {
+				continue;
+			}
+			std::vector<ArtNetAddress> &destinations = table->routes[node.output_ports[i]];
+			bool known = std::any_of(destinations.begin(), destinations.end(), [&node](const ArtNetAddress &address) {
+				return address.ip == node.address.ip;
+			});
+			if (!known) {
+				destinations.push_back(node.address);
+			}
+		}
+	}
+	std::atomic_store(&routing_table, std::shared_ptr<const ArtNetRoutingTable>(std::move(table)));
+}
+
+void ArtNetDiscovery::publish_nodes() {
+	std::shared_ptr<ArtNetNodeTable> table = std::make_shared<ArtNetNodeTable>();
+	table->nodes.reserve(nodes.size());
+	for (const auto &entry : nodes) {
+		const ArtNetNode &node = entry.second;
+		uint32_t index = static_cast<uint32_t>(table->nodes.size());
+		table->nodes.push_back(node);
+		for (size_t i = 0; i < node.port_count; i++) {
+			if (node.is_output(i)) {
+				table->ports[node.output_ports[i]].push_back(index);
+			}
+			if (node.is_input(i)) {
+				table->ports[node.input_ports[i]].push_back(index);
+			}
+		}
+	}
+	// A node with several ports on one Port-Address is listed once.
+	for (auto &entry : table->ports) {
+		entry.second.erase(std::unique(entry.second.begin(), entry.second.end()), entry.second.end());
+	}
+	seen = false;
+	std::atomic_store(&node_table, std::shared_ptr<const ArtNetNodeTable>(std::move(table)));
+}
+
+std::shared_ptr<const ArtNetRoutingTable> ArtNetDiscovery::get_routing_table() const {
+	return std::atomic_load(&routing_table);
+}
+
+std::shared_ptr<const ArtNetNodeTable> ArtNetDiscovery::get_node_table() const {
+	return std::atomic_load(&node_table);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "artnet_protocol.h"
+#include "artnet_socket.h"
+
+// Port-Address -> node endpoints subscribed to it. Immutable once published,
+// so the send path can read it without locking.
+struct ArtNetRoutingTable {
+	std::unordered_map<uint16_t, std::vector<ArtNetAddress>> routes;
+
+	const std::vector<ArtNetAddress> *find(uint16_t port_address) const {
+		auto it = routes.find(port_address);
+		return it != routes.end() ? &it->second : nullptr;
+	}
+};
+
+// State a node reports in its ArtPollReply (or in the reply it sends after an
+// ArtAddress reprograms it). Fixed size, so a table of them is one block.
+struct ArtNetNode {
+	ArtNetAddress address;
+	uint8_t bind_index = 0;
+	uint8_t status1 = 0;
+	uint8_t status2 = 0;
+	uint8_t port_count = 0;
+	uint16_t oem = 0;
+	uint16_t esta_manufacturer = 0;
+	uint16_t firmware_version = 0;
+	uint8_t mac[6] = {};
+	char short_name[ARTNET_SHORT_NAME_SIZE] = {}; // always null-terminated
+	char long_name[ARTNET_LONG_NAME_SIZE] = {}; // always null-terminated
+	uint8_t port_types[4] = {};
+	uint8_t good_input[4] = {};
+	uint8_t good_output[4] = {};
+	uint16_t input_ports[4] = {}; // Port-Addresses
+	uint16_t output_ports[4] = {}; // Port-Addresses
+	// Bumped whenever any field above changes; last_seen does not count.
+	uint32_t revision = 0;
+	std::chrono::steady_clock::time_point last_seen;
+
+	bool is_output(size_t port) const { return port < port_count && (port_types[port] & ARTNET_PORT_TYPE_OUTPUT); }
+	bool is_input(size_t port) const { return port < port_count && (port_types[port] & ARTNET_PORT_TYPE_INPUT); }
+	bool same_state(const ArtNetNode &other) const;
+};
+
+// Snapshot of every known node, sorted by (IP, BindIndex), with a
+// Port-Address index into it. Immutable once published, like the routing
+// table.
+struct ArtNetNodeTable {
+	enum ChangeType : uint8_t {
+		NODE_ADDED,
+		NODE_CHANGED,
+		NODE_LOST,
+	};
+
+	struct Change {
+		ChangeType type;
+		const ArtNetNode *node; // points into the newer table, or the older one for NODE_LOST
+	};
+
+	std::vector<ArtNetNode> nodes;
+	// Port-Address -> indices of the nodes with an input or output port on it.
+	std::unordered_map<uint16_t, std::vector<uint32_t>> ports;
+
+	const std::vector<uint32_t> *find(uint16_t port_address) const {
+		auto it = ports.find(port_address);
+		return it != ports.end() ? &it->second : nullptr;
+	}
+
+	// Appends what changed between two snapshots in one merge pass over the
+	// sorted node lists. Both tables must outlive r_changes.
+	static void diff(const ArtNetNodeTable &before, const ArtNetNodeTable &after, std::vector<Change> &r_changes);
+};
+
+// Builds the unicast routing table and the node table from ArtPollReply
+// traffic. Packets are fed in by the receive thread; the routing table is
+// republished whenever a node's ports change, and the node table whenever
+// any node changes and once per poll to refresh last-seen times.
+class ArtNetDiscovery {
+	// Keyed by (IP, BindIndex) so multi-port gateways that answer once per
+	// group of four ports are tracked as separate entries.
+	std::map<std::pair<uint32_t, uint8_t>, ArtNetNode> nodes;
+	bool seen = false; // a known node replied since the node table was last published
+	std::shared_ptr<const ArtNetRoutingTable> routing_table = std::make_shared<ArtNetRoutingTable>();
+	std::shared_ptr<const ArtNetNodeTable> node_table = std::make_shared<ArtNetNodeTable>();
+
+	void publish_routes();
+	void publish_nodes();
+
+public:
+	// Receive thread only.
+	bool handle_poll_reply(const uint8_t *data, size_t size, const ArtNetAddress &from, std::chrono::steady_clock::time_point now);
+	void expire(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration timeout);
+	void clear();
+
+	// Any thread.
+	std::shared_ptr<const ArtNetRoutingTable> get_routing_table() const;
+	std::shared_ptr<const ArtNetNodeTable> get_node_table() const;
+};
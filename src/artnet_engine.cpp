@@ -0,0 +1,166 @@
+#include "artnet_engine.h"
+
+#include <godot_cpp/classes/performance.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+#include "artnet_log.h"
+#include "artnet_stats.h"
+#include "artnet_transport.h"
+
+using namespace godot;
+
+ArtNetEngine *ArtNetEngine::singleton = nullptr;
+
+namespace {
+
+const char *const MONITOR_PACKETS_SENT = "ArtNet/packets_sent";
+const char *const MONITOR_PACKETS_DROPPED = "ArtNet/packets_dropped";
+const char *const MONITOR_BYTES_SENT = "ArtNet/bytes_sent";
+const char *const MONITOR_SEND_ERRORS = "ArtNet/send_errors";
+const char *const MONITOR_SEND_LATENCY_AVERAGE = "ArtNet/send_latency_avg_usec";
+const char *const MONITOR_SEND_LATENCY_MAX = "ArtNet/send_latency_max_usec";
+const char *const MONITOR_SENDER_OVERRUNS = "ArtNet/sender_overruns";
+const char *const MONITOR_OLDEST_UNIVERSE_AGE = "ArtNet/oldest_universe_age_msec";
+
+} // namespace
+
+void ArtNetEngine::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_open_socket_count"), &ArtNetEngine::get_open_socket_count);
+	ClassDB::bind_method(D_METHOD("get_active_sender_count"), &ArtNetEngine::get_active_sender_count);
+	ClassDB::bind_method(D_METHOD("is_sender_running"), &ArtNetEngine::is_sender_running);
+
+	ClassDB::bind_method(D_METHOD("get_packets_sent"), &ArtNetEngine::get_packets_sent);
+	ClassDB::bind_method(D_METHOD("get_packets_dropped"), &ArtNetEngine::get_packets_dropped);
+	ClassDB::bind_method(D_METHOD("get_bytes_sent"), &ArtNetEngine::get_bytes_sent);
+	ClassDB::bind_method(D_METHOD("get_send_errors"), &ArtNetEngine::get_send_errors);
+	ClassDB::bind_method(D_METHOD("get_send_error_counts"), &ArtNetEngine::get_send_error_counts);
+	ClassDB::bind_method(D_METHOD("get_average_send_latency_usec"), &ArtNetEngine::get_average_send_latency_usec);
+	ClassDB::bind_method(D_METHOD("get_max_send_latency_usec"), &ArtNetEngine::get_max_send_latency_usec);
+	ClassDB::bind_method(D_METHOD("get_sender_overruns"), &ArtNetEngine::get_sender_overruns);
+	ClassDB::bind_method(D_METHOD("get_oldest_universe_age_msec"), &ArtNetEngine::get_oldest_universe_age_msec);
+	ClassDB::bind_method(D_METHOD("reset_stats"), &ArtNetEngine::reset_stats);
+	ClassDB::bind_method(D_METHOD("get_log_messages_dropped"), &ArtNetEngine::get_log_messages_dropped);
+}
+
+ArtNetEngine *ArtNetEngine::get_singleton() {
+	return singleton;
+}
+
+ArtNetEngine::ArtNetEngine() {
+	singleton = this;
+	// Godot's print functions are thread-safe, so the log consumer thread can
+	// forward to them directly without going through the main loop.
+	ArtNetLog::get_singleton().start([](ArtNetLogLevel level, const char *message) {
+		String text = String("ArtNet: ") + String(message);
+		if (level == ARTNET_LOG_ERROR) {
+			UtilityFunctions::push_warning(text);
+		} else {
+			UtilityFunctions::print(text);
+		}
+	});
+}
+
+ArtNetEngine::~ArtNetEngine() {
+	ArtNetTransport::get_singleton().shutdown();
+	ArtNetLog::get_singleton().stop();
+	singleton = nullptr;
+}
+
+int ArtNetEngine::get_open_socket_count() const {
+	return static_cast<int>(ArtNetTransport::get_singleton().get_open_socket_count());
+}
+
+int ArtNetEngine::get_active_sender_count() const {
+	return static_cast<int>(ArtNetTransport::get_singleton().get_active_output_count());
+}
+
+bool ArtNetEngine::is_sender_running() const {
+	return ArtNetTransport::get_singleton().is_sender_running();
+}
+
+int64_t ArtNetEngine::get_packets_sent() const {
+	return static_cast<int64_t>(ArtNetStats::get_singleton().get_packets_sent());
+}
+
+int64_t ArtNetEngine::get_packets_dropped() const {
+	return static_cast<int64_t>(ArtNetStats::get_singleton().get_packets_dropped());
+}
+
+int64_t ArtNetEngine::get_bytes_sent() const {
+	return static_cast<int64_t>(ArtNetStats::get_singleton().get_bytes_sent());
+}
+
+int64_t ArtNetEngine::get_send_errors() const {
+	return static_cast<int64_t>(ArtNetStats::get_singleton().get_send_errors());
+}
+
+Dictionary ArtNetEngine::get_send_error_counts() const {
+	Dictionary counts;
+	for (const std::pair<int, uint64_t> &entry : ArtNetStats::get_singleton().get_send_error_counts()) {
+		counts[entry.first] = static_cast<int64_t>(entry.second);
+	}
+	return counts;
+}
+
+double ArtNetEngine::get_average_send_latency_usec() const {
+	return ArtNetStats::get_singleton().get_average_send_latency_ns() / 1000.0;
+}
+
+double ArtNetEngine::get_max_send_latency_usec() const {
+	return ArtNetStats::get_singleton().get_max_send_latency_ns() / 1000.0;
+}
+
+int64_t ArtNetEngine::get_sender_overruns() const {
+	return static_cast<int64_t>(ArtNetStats::get_singleton().get_sender_overruns());
+}
+
+double ArtNetEngine::get_oldest_universe_age_msec() const {
+	double age = ArtNetTransport::get_singleton().get_oldest_send_age();
+	return age < 0.0 ? 0.0 : age * 1000.0;
+}
+
+void ArtNetEngine::reset_stats() {
+	ArtNetStats::get_singleton().reset();
+}
+
+int64_t ArtNetEngine::get_log_messages_dropped() const {
+	return static_cast<int64_t>(ArtNetLog::get_singleton().get_dropped_count());
+}
+
+void ArtNetEngine::add_performance_monitors() {
+	Performance *performance = Performance::get_singleton();
+	if (!performance) {
+		return;
+	}
+	performance->add_custom_monitor(MONITOR_PACKETS_SENT, callable_mp(this, &ArtNetEngine::get_packets_sent));
+	performance->add_custom_monitor(MONITOR_PACKETS_DROPPED, callable_mp(this, &ArtNetEngine::get_packets_dropped));
+	performance->add_custom_monitor(MONITOR_BYTES_SENT, callable_mp(this, &ArtNetEngine::get_bytes_sent));
+	performance->add_custom_monitor(MONITOR_SEND_ERRORS, callable_mp(this, &ArtNetEngine::get_send_errors));
+	performance->add_custom_monitor(MONITOR_SEND_LATENCY_AVERAGE, callable_mp(this, &ArtNetEngine::get_average_send_latency_usec));
+	performance->add_custom_monitor(MONITOR_SEND_LATENCY_MAX, callable_mp(this, &ArtNetEngine::get_max_send_latency_usec));
+	performance->add_custom_monitor(MONITOR_SENDER_OVERRUNS, callable_mp(this, &ArtNetEngine::get_sender_overruns));
+	performance->add_custom_monitor(MONITOR_OLDEST_UNIVERSE_AGE, callable_mp(this, &ArtNetEngine::get_oldest_universe_age_msec));
+}
+
+void ArtNetEngine::remove_performance_monitors() {
+	Performance *performance = Performance::get_singleton();
+	if (!performance) {
+		return;
+	}
+	const char *const monitors[] = {
+		MONITOR_PACKETS_SENT,
+		MONITOR_PACKETS_DROPPED,
+		MONITOR_BYTES_SENT,
+		MONITOR_SEND_ERRORS,
+		MONITOR_SEND_LATENCY_AVERAGE,
+		MONITOR_SEND_LATENCY_MAX,
+		MONITOR_SENDER_OVERRUNS,
+		MONITOR_OLDEST_UNIVERSE_AGE,
+	};
+	for (const char *monitor : monitors) {
+		if (performance->has_custom_monitor(monitor)) {
+			performance->remove_custom_monitor(monitor);
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "godot_cpp/classes/object.hpp"
+#include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+
+using namespace godot;
+
+// Engine singleton exposing the process-wide transport that every
+// ArtNetController feeds into: one socket per bind address and one sender
+// thread for all controllers.
+class ArtNetEngine : public Object {
+	GDCLASS(ArtNetEngine, Object)
+
+	static ArtNetEngine *singleton;
+
+protected:
+	static void _bind_methods();
+
+public:
+	static ArtNetEngine *get_singleton();
+
+	ArtNetEngine();
+	~ArtNetEngine() override;
+
+	int get_open_socket_count() const;
+	int get_active_sender_count() const;
+	bool is_sender_running() const;
+
+	// Send path statistics, also registered as Performance custom monitors.
+	int64_t get_packets_sent() const;
+	int64_t get_packets_dropped() const;
+	int64_t get_bytes_sent() const;
+	int64_t get_send_errors() const;
+	Dictionary get_send_error_counts() const;
+	double get_average_send_latency_usec() const;
+	double get_max_send_latency_usec() const;
+	int64_t get_sender_overruns() const;
+	double get_oldest_universe_age_msec() const;
+	void reset_stats();
+
+	int64_t get_log_messages_dropped() const;
+
+	void add_performance_monitors();
+	void remove_performance_monitors();
+};
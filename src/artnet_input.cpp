@@ -0,0 +1,147 @@
+#include "artnet_input.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "artnet_log.h"
+#include "artnet_transport.h"
+
+ArtNetInput::~ArtNetInput() {
+	stop();
+}
+
+bool ArtNetInput::listen(uint16_t port_address) {
+	if (running || port_address > ARTNET_MAX_PORT_ADDRESS) {
+		return false;
+	}
+	if (!universes.find(port_address)) {
+		DmxInputUniverse *universe = universes.insert(port_address);
+		universe->port_address = port_address;
+		universe_list.push_back(universe);
+	}
+	return true;
+}
+
+void ArtNetInput::clear() {
+	if (running) {
+		return;
+	}
+	universes.clear();
+	universe_list.clear();
+}
+
+bool ArtNetInput::start(const std::shared_ptr<ArtNetEndpoint> &p_endpoint) {
+	if (running || !p_endpoint || universe_list.empty()) {
+		return false;
+	}
+	// Hold the socket open for as long as we are attached to it.
+	if (!p_endpoint->open()) {
+		return false;
+	}
+	for (DmxInputUniverse *universe : universe_list) {
+		for (DmxInputUniverse::Source &source : universe->sources) {
+			source.ip = 0;
+		}
+		universe->index.reset();
+	}
+	endpoint = p_endpoint;
+	endpoint->add_input(this);
+	running = true;
+	return true;
+}
+
+void ArtNetInput::stop() {
+	if (!running) {
+		return;
+	}
+	endpoint->remove_input(this);
+	endpoint->close();
+	endpoint.reset();
+	running = false;
+}
+
+DmxInputUniverse *ArtNetInput::find_universe(uint16_t port_address) const {
+	return universes.find(port_address);
+}
+
+bool ArtNetInput::handle_dmx(const uint8_t *packet, size_t size, const ArtNetAddress &from, std::chrono::steady_clock::time_point now) {
+	ArtNetDmxPacket dmx;
+	if (!artnet_parse_dmx(packet, size, dmx)) {
+		return false;
+	}
+	uint16_t port_address = dmx.port_address;
+	DmxInputUniverse *found = universes.find(port_address);
+	if (!found) {
+		return false;
+	}
+	DmxInputUniverse &universe = *found;
+	packets_received.fetch_add(1, std::memory_order_relaxed);
+
+	// Find this sender's slot, recycling slots whose source has gone quiet.
+	DmxInputUniverse::Source *source = nullptr;
+	DmxInputUniverse::Source *free_slot = nullptr;
+	for (DmxInputUniverse::Source &candidate : universe.sources) {
+		if (candidate.ip != 0 && now - candidate.last_seen > SOURCE_TIMEOUT) {
+			candidate.ip = 0;
+		}
+		if (candidate.ip == from.ip && candidate.port == from.port) {
+			source = &candidate;
+		} else if (candidate.ip == 0 && !free_slot) {
+			free_slot = &candidate;
+		}
+	}
+	if (!source) {
+		if (!free_slot) {
+			// A third live source; Art-Net merging only covers two.
+			packets_dropped.fetch_add(1, std::memory_order_relaxed);
+			ArtNetLog::get_singleton().write(ARTNET_LOG_DEBUG, "dropped ArtDmx for universe %lld from a third source", port_address);
+			return true;
+		}
+		const uint8_t *ip = reinterpret_cast<const uint8_t *>(&from.ip);
+		ArtNetLog::get_singleton().write(ARTNET_LOG_INFO, "universe %lld: new source %lld.%lld.%lld.%lld:%lld", port_address, ip[0], ip[1], ip[2], ip[3], from.port);
+		source = free_slot;
+		source->ip = from.ip;
+		source->port = from.port;
+		source->sequence = 0;
+	}
+
+	// Drop packets that arrive shortly behind one already applied. Sequence 0
+	// means the sender does not use sequencing.
+	uint8_t sequence = dmx.sequence;
+	if (sequence != 0 && source->sequence != 0) {
+		int8_t delta = static_cast<int8_t>(sequence - source->sequence);
+		if (delta < 0 && delta > -64) {
+			packets_dropped.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	std::memcpy(source->data, dmx.data, dmx.length);
+	std::memset(source->data + dmx.length, 0, DMX_UNIVERSE_SIZE - dmx.length);
+	source->length = dmx.length;
+	source->sequence = sequence;
+	source->last_seen = now;
+
+	merge(universe, *source);
+	return true;
+}
+
+void ArtNetInput::merge(DmxInputUniverse &universe, const DmxInputUniverse::Source &latest) {
+	uint8_t back = universe.index.back();
+	uint8_t *frame = universe.frames[back];
+
+	const DmxInputUniverse::Source *other = &universe.sources[0] == &latest ? &universe.sources[1] : &universe.sources[0];
+	if (merge_mode.load(std::memory_order_relaxed) == MERGE_MODE_LTP || other->ip == 0) {
+		std::memcpy(frame, latest.data, DMX_UNIVERSE_SIZE);
+		universe.frame_length[back] = latest.length;
+	} else {
+		// Both sources zero their tails, so a plain per-channel max is enough.
+		for (size_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+			frame[i] = std::max(latest.data[i], other->data[i]);
+		}
+		universe.frame_length[back] = std::max(latest.length, other->length);
+	}
+
+	universe.index.publish();
+	pending.store(true, std::memory_order_release);
+}
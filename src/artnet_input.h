@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "artnet_protocol.h"
+#include "artnet_socket.h"
+#include "dmx_universe_arena.h"
+#include "triple_buffer.h"
+
+class ArtNetEndpoint;
+
+// Receive-side storage for one universe. Everything is allocated up front when
+// the universe is subscribed, so the receive thread never touches the heap.
+// Merged frames are handed to the main thread through a TripleBufferIndex.
+struct DmxInputUniverse {
+	// Art-Net merges at most two sources per universe.
+	struct Source {
+		uint32_t ip = 0; // 0 marks a free slot
+		uint16_t port = 0;
+		uint8_t sequence = 0;
+		uint16_t length = 0;
+		std::chrono::steady_clock::time_point last_seen;
+		alignas(64) uint8_t data[DMX_UNIVERSE_SIZE] = {};
+	};
+
+	uint16_t port_address = 0;
+
+	// Receive thread only.
+	Source sources[2];
+
+	alignas(64) uint8_t frames[3][DMX_UNIVERSE_SIZE] = {};
+	uint16_t frame_length[3] = {};
+	TripleBufferIndex index;
+};
+
+// Parses ArtDmx packets for a set of subscribed universes and merges up to two
+// sources per universe, either highest-takes-precedence (per channel) or
+// latest-takes-precedence (whole packet).
+class ArtNetInput {
+public:
+	enum MergeMode {
+		MERGE_MODE_HTP,
+		MERGE_MODE_LTP,
+	};
+
+	// Sources that have not sent for this long are dropped from the merge.
+	static constexpr std::chrono::seconds SOURCE_TIMEOUT{ 10 };
+
+private:
+	std::shared_ptr<ArtNetEndpoint> endpoint;
+	bool running = false;
+
+	// Fixed while running, so the receive thread can look universes up without locking.
+	DmxUniverseArena<DmxInputUniverse> universes;
+	std::vector<DmxInputUniverse *> universe_list;
+
+	std::atomic<int> merge_mode{ MERGE_MODE_HTP };
+	std::atomic<bool> pending{ false };
+	std::atomic<uint64_t> packets_received{ 0 };
+	std::atomic<uint64_t> packets_dropped{ 0 };
+
+	void merge(DmxInputUniverse &universe, const DmxInputUniverse::Source &latest);
+
+public:
+	~ArtNetInput();
+
+	// Subscribes a universe. Only allowed while stopped.
+	bool listen(uint16_t port_address);
+	void clear();
+
+	// Attaches to the endpoint's receive thread.
+	bool start(const std::shared_ptr<ArtNetEndpoint> &p_endpoint);
+	void stop();
+	bool is_running() const { return running; }
+
+	void set_merge_mode(MergeMode mode) { merge_mode = mode; }
+	MergeMode get_merge_mode() const { return static_cast<MergeMode>(merge_mode.load()); }
+
+	// Receive thread: parses one packet. Returns false if it was not for us.
+	bool handle_dmx(const uint8_t *packet, size_t size, const ArtNetAddress &from, std::chrono::steady_clock::time_point now);
+
+	// Main thread: true if any universe has published a frame since the last call.
+	bool take_pending() { return pending.exchange(false, std::memory_order_acquire); }
+	const std::vector<DmxInputUniverse *> &get_universes() const { return universe_list; }
+	DmxInputUniverse *find_universe(uint16_t port_address) const;
+
+	uint64_t get_packets_received() const { return packets_received.load(std::memory_order_relaxed); }
+	uint64_t get_packets_dropped() const { return packets_dropped.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,121 @@
+#include "artnet_log.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+// How long queued records may wait before the consumer formats them.
+constexpr std::chrono::milliseconds CONSUMER_INTERVAL{ 20 };
+
+} // namespace
+
+ArtNetLog::ArtNetLog() {
+	for (size_t i = 0; i < CAPACITY; i++) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+ArtNetLog &ArtNetLog::get_singleton() {
+	static ArtNetLog log;
+	return log;
+}
+
+bool ArtNetLog::push(ArtNetLogLevel record_level, const char *format, const long long *args, size_t count) {
+	// Bounded queue after Dmitry Vyukov: each cell's sequence says whether it
+	// is free for the producer that claimed this position or still holds an
+	// unread record from the previous lap.
+	size_t position = enqueue_position.load(std::memory_order_relaxed);
+	Cell *cell;
+	for (;;) {
+		cell = &cells[position & (CAPACITY - 1)];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+		if (difference == 0) {
+			if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		} else if (difference < 0) {
+			return false; // full
+		} else {
+			position = enqueue_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->record.format = format;
+	cell->record.level = static_cast<uint8_t>(record_level);
+	for (size_t i = 0; i < MAX_ARGS; i++) {
+		cell->record.args[i] = i < count ? args[i] : 0;
+	}
+	cell->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+bool ArtNetLog::pop(Record &r_record) {
+	Cell &cell = cells[dequeue_position & (CAPACITY - 1)];
+	size_t sequence = cell.sequence.load(std::memory_order_acquire);
+	if (sequence != dequeue_position + 1) {
+		return false; // empty, or the producer has not finished writing
+	}
+	r_record = cell.record;
+	cell.sequence.store(dequeue_position + CAPACITY, std::memory_order_release);
+	dequeue_position++;
+	return true;
+}
+
+void ArtNetLog::drain() {
+	char message[256];
+	Record record;
+	while (pop(record)) {
+		if (!sink) {
+			continue;
+		}
+		const long long *a = record.args;
+		std::snprintf(message, sizeof(message), record.format, a[0], a[1], a[2], a[3], a[4], a[5]);
+		sink(static_cast<ArtNetLogLevel>(record.level), message);
+	}
+
+	uint64_t total_dropped = dropped.load(std::memory_order_relaxed);
+	if (total_dropped != dropped_reported) {
+		if (sink) {
+			std::snprintf(message, sizeof(message), "log ring full, %llu messages dropped", static_cast<unsigned long long>(total_dropped - dropped_reported));
+			sink(ARTNET_LOG_ERROR, message);
+		}
+		dropped_reported = total_dropped;
+	}
+}
+
+void ArtNetLog::consumer_loop() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!consumer_stop) {
+		// Producers never signal; they must not touch the mutex.
+		wake.wait_for(lock, CONSUMER_INTERVAL, [this] { return consumer_stop; });
+		drain();
+	}
+}
+
+void ArtNetLog::start(Sink p_sink) {
+	std::unique_lock<std::mutex> lock(mutex);
+	if (consumer.joinable()) {
+		return;
+	}
+	sink = std::move(p_sink);
+	consumer_stop = false;
+	consumer = std::thread(&ArtNetLog::consumer_loop, this);
+}
+
+void ArtNetLog::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!consumer.joinable()) {
+			return;
+		}
+		consumer_stop = true;
+	}
+	wake.notify_all();
+	consumer.join();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	drain();
+	sink = nullptr;
+}
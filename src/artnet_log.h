@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Matches the levels accepted by ArtNetController.set_log_level().
+enum ArtNetLogLevel {
+	ARTNET_LOG_NONE,
+	ARTNET_LOG_ERROR,
+	ARTNET_LOG_INFO,
+	ARTNET_LOG_DEBUG,
+};
+
+// Asynchronous logger for the native engine. Threads on the send and receive
+// paths only copy a fixed-size binary record (a printf format and up to
+// MAX_ARGS integers) into a bounded lock-free MPSC ring; a background consumer
+// formats the records and hands the text to a sink. When the ring is full the
+// record is dropped and counted instead of blocking the caller.
+class ArtNetLog {
+public:
+	static constexpr size_t CAPACITY = 1024; // power of two
+	static constexpr size_t MAX_ARGS = 6;
+
+	using Sink = std::function<void(ArtNetLogLevel level, const char *message)>;
+
+private:
+	struct Record {
+		const char *format = nullptr; // must be a string literal
+		long long args[MAX_ARGS] = {};
+		uint8_t level = ARTNET_LOG_NONE;
+	};
+
+	struct Cell {
+		std::atomic<size_t> sequence{ 0 };
+		Record record;
+	};
+
+	Cell cells[CAPACITY];
+	alignas(64) std::atomic<size_t> enqueue_position{ 0 };
+	alignas(64) size_t dequeue_position = 0; // consumer only
+
+	std::atomic<int> level{ ARTNET_LOG_ERROR };
+	std::atomic<uint64_t> dropped{ 0 };
+	uint64_t dropped_reported = 0; // consumer only
+
+	// Consumer thread control.
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::thread consumer;
+	bool consumer_stop = false;
+	Sink sink;
+
+	ArtNetLog();
+
+	bool push(ArtNetLogLevel record_level, const char *format, const long long *args, size_t count);
+	bool pop(Record &r_record);
+	void drain();
+	void consumer_loop();
+
+public:
+	static ArtNetLog &get_singleton();
+
+	void set_level(ArtNetLogLevel p_level) { level.store(p_level, std::memory_order_relaxed); }
+	ArtNetLogLevel get_level() const { return static_cast<ArtNetLogLevel>(level.load(std::memory_order_relaxed)); }
+	bool is_enabled(ArtNetLogLevel record_level) const { return record_level != ARTNET_LOG_NONE && record_level <= level.load(std::memory_order_relaxed); }
+
+	// Queues a message. Safe from any thread, never blocks or allocates.
+	// format is kept by pointer, so it must be a string literal; each
+	// argument is passed to it as a long long (use %lld).
+	template <typename... Args>
+	void write(ArtNetLogLevel record_level, const char *format, Args... args) {
+		static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+		if (!is_enabled(record_level)) {
+			return;
+		}
+		const long long values[sizeof...(Args) + 1] = { static_cast<long long>(args)..., 0 };
+		if (!push(record_level, format, values, sizeof...(Args))) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	// Starts the consumer thread, which formats queued records and passes them
+	// to sink every few milliseconds. stop() flushes what is left.
+	void start(Sink p_sink);
+	void stop();
+
+	uint64_t get_dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,194 @@
+#include "artnet_node_simulator.h"
+
+#include <algorithm>
+#include <cstring>
+
+ArtNetNodeSimulator::~ArtNetNodeSimulator() {
+	stop();
+}
+
+bool ArtNetNodeSimulator::listen(uint16_t port_address) {
+	if (running || port_address > ARTNET_MAX_PORT_ADDRESS) {
+		return false;
+	}
+	if (!universes.find(port_address)) {
+		DmxSimulatedUniverse *universe = universes.insert(port_address);
+		universe->port_address = port_address;
+		auto position = std::lower_bound(universe_list.begin(), universe_list.end(), port_address, [](const DmxSimulatedUniverse *entry, uint16_t address) {
+			return entry->port_address < address;
+		});
+		universe_list.insert(position, universe);
+	}
+	return true;
+}
+
+void ArtNetNodeSimulator::clear() {
+	if (running) {
+		return;
+	}
+	universes.clear();
+	universe_list.clear();
+}
+
+bool ArtNetNodeSimulator::set_latency_stamp_channel(int channel) {
+	if (running || channel < -1 || channel > static_cast<int>(DMX_UNIVERSE_SIZE - ARTNET_LATENCY_STAMP_SIZE)) {
+		return false;
+	}
+	latency_stamp_channel = channel;
+	return true;
+}
+
+bool ArtNetNodeSimulator::start(const ArtNetAddress &bind_address) {
+	if (running || universe_list.empty() || !socket.open(bind_address)) {
+		return false;
+	}
+	for (DmxSimulatedUniverse *universe : universe_list) {
+		universe->seen = false;
+		universe->index.reset();
+	}
+	reset_stats();
+	receiver_stop = false;
+	receiver = std::thread(&ArtNetNodeSimulator::receiver_loop, this);
+	running = true;
+	return true;
+}
+
+void ArtNetNodeSimulator::stop() {
+	if (!running) {
+		return;
+	}
+	receiver_stop = true;
+	receiver.join();
+	socket.close();
+	running = false;
+}
+
+void ArtNetNodeSimulator::receiver_loop() {
+	// Large enough for any Art-Net packet, including a full ArtDmx.
+	uint8_t packet[1024];
+	while (!receiver_stop.load(std::memory_order_relaxed)) {
+		ArtNetAddress from;
+		int size = socket.receive(packet, sizeof(packet), from, 100);
+		if (size > 0) {
+			handle_packet(packet, static_cast<size_t>(size), std::chrono::steady_clock::now());
+		}
+	}
+}
+
+void ArtNetNodeSimulator::handle_packet(const uint8_t *packet, size_t size, std::chrono::steady_clock::time_point now) {
+	ArtNetDmxPacket dmx;
+	if (!artnet_parse_dmx(packet, size, dmx)) {
+		if (artnet_read_opcode(packet, size) == ARTNET_OP_SYNC) {
+			syncs_received.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			packets_ignored.fetch_add(1, std::memory_order_relaxed);
+		}
+		return;
+	}
+	DmxSimulatedUniverse *found = universes.find(dmx.port_address);
+	if (!found) {
+		packets_ignored.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	DmxSimulatedUniverse &universe = *found;
+	packets_received.fetch_add(1, std::memory_order_relaxed);
+	universe.packets.fetch_add(1, std::memory_order_relaxed);
+
+	if (universe.seen) {
+		// Exponential moving average over roughly the last eight packets.
+		int64_t interval = std::chrono::duration_cast<std::chrono::microseconds>(now - universe.last_arrival).count();
+		uint32_t sample = static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(interval, 0), UINT32_MAX));
+		uint32_t average = universe.interval_usec.load(std::memory_order_relaxed);
+		universe.interval_usec.store(average == 0 ? sample : static_cast<uint32_t>((static_cast<uint64_t>(average) * 7 + sample) / 8), std::memory_order_relaxed);
+	}
+	universe.last_arrival = now;
+
+	// Sequence numbers run 1..255, so distances are taken on a ring of 255.
+	// Packets less than 64 steps behind the last one count as reordered,
+	// the same window ArtNetInput drops.
+	if (dmx.sequence != 0 && universe.seen && universe.sequence != 0) {
+		int distance = (static_cast<int>(dmx.sequence) - static_cast<int>(universe.sequence) + 255) % 255;
+		if (distance == 0) {
+			universe.duplicates.fetch_add(1, std::memory_order_relaxed);
+		} else if (distance > 255 - 64) {
+			universe.out_of_order.fetch_add(1, std::memory_order_relaxed);
+			return;
+		} else if (distance > 1) {
+			universe.lost.fetch_add(static_cast<uint64_t>(distance - 1), std::memory_order_relaxed);
+		}
+	}
+	universe.sequence = dmx.sequence;
+	universe.seen = true;
+
+	if (latency_stamp_channel >= 0 && dmx.length >= latency_stamp_channel + ARTNET_LATENCY_STAMP_SIZE) {
+		int64_t stamp = read_latency_stamp(dmx.data + latency_stamp_channel);
+		int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count() - stamp;
+		// Frames that carry no stamp (or one from another clock) are skipped.
+		if (stamp > 0 && latency >= 0 && latency < 10000000) {
+			universe.latency_total_usec.fetch_add(static_cast<uint64_t>(latency), std::memory_order_relaxed);
+			universe.latency_samples.fetch_add(1, std::memory_order_relaxed);
+			if (latency > universe.latency_max_usec.load(std::memory_order_relaxed)) {
+				universe.latency_max_usec.store(latency, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	uint8_t back = universe.index.back();
+	std::memcpy(universe.frames[back], dmx.data, dmx.length);
+	std::memset(universe.frames[back] + dmx.length, 0, DMX_UNIVERSE_SIZE - dmx.length);
+	universe.frame_length[back] = dmx.length;
+	universe.index.publish();
+	pending.store(true, std::memory_order_release);
+}
+
+void ArtNetNodeSimulator::read_stats(const DmxSimulatedUniverse &universe, DmxSimulatedUniverseStats &r_stats) {
+	r_stats.packets = universe.packets.load(std::memory_order_relaxed);
+	r_stats.lost = universe.lost.load(std::memory_order_relaxed);
+	r_stats.out_of_order = universe.out_of_order.load(std::memory_order_relaxed);
+	r_stats.duplicates = universe.duplicates.load(std::memory_order_relaxed);
+	uint32_t interval = universe.interval_usec.load(std::memory_order_relaxed);
+	r_stats.rate_hz = interval > 0 ? 1000000.0 / interval : 0.0;
+	uint64_t samples = universe.latency_samples.load(std::memory_order_relaxed);
+	if (samples > 0) {
+		r_stats.latency_avg_usec = static_cast<double>(universe.latency_total_usec.load(std::memory_order_relaxed)) / static_cast<double>(samples);
+		r_stats.latency_max_usec = static_cast<double>(universe.latency_max_usec.load(std::memory_order_relaxed));
+	} else {
+		r_stats.latency_avg_usec = -1.0;
+		r_stats.latency_max_usec = -1.0;
+	}
+}
+
+void ArtNetNodeSimulator::reset_stats() {
+	for (DmxSimulatedUniverse *universe : universe_list) {
+		universe->packets.store(0, std::memory_order_relaxed);
+		universe->lost.store(0, std::memory_order_relaxed);
+		universe->out_of_order.store(0, std::memory_order_relaxed);
+		universe->duplicates.store(0, std::memory_order_relaxed);
+		universe->interval_usec.store(0, std::memory_order_relaxed);
+		universe->latency_total_usec.store(0, std::memory_order_relaxed);
+		universe->latency_samples.store(0, std::memory_order_relaxed);
+		universe->latency_max_usec.store(0, std::memory_order_relaxed);
+	}
+	packets_received.store(0, std::memory_order_relaxed);
+	packets_ignored.store(0, std::memory_order_relaxed);
+	syncs_received.store(0, std::memory_order_relaxed);
+}
+
+int64_t ArtNetNodeSimulator::get_clock_usec() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ArtNetNodeSimulator::write_latency_stamp(uint8_t *dst, int64_t time_usec) {
+	uint64_t value = static_cast<uint64_t>(time_usec);
+	for (size_t i = 0; i < ARTNET_LATENCY_STAMP_SIZE; i++) {
+		dst[i] = static_cast<uint8_t>(value >> (8 * (ARTNET_LATENCY_STAMP_SIZE - 1 - i)));
+	}
+}
+
+int64_t ArtNetNodeSimulator::read_latency_stamp(const uint8_t *src) {
+	uint64_t value = 0;
+	for (size_t i = 0; i < ARTNET_LATENCY_STAMP_SIZE; i++) {
+		value = (value << 8) | src[i];
+	}
+	return static_cast<int64_t>(value);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "artnet_protocol.h"
+#include "artnet_socket.h"
+#include "dmx_universe_arena.h"
+#include "triple_buffer.h"
+
+// Size of the timestamp a sender can embed in a universe so the simulator
+// can measure latency: microseconds on the steady clock, big-endian.
+static constexpr size_t ARTNET_LATENCY_STAMP_SIZE = 8;
+
+// One universe received by the simulator. Like DmxInputUniverse, everything
+// is allocated when the universe is subscribed and frames are handed to the
+// reader through a TripleBufferIndex.
+struct DmxSimulatedUniverse {
+	uint16_t port_address = 0;
+
+	// Receive thread only.
+	uint8_t sequence = 0;
+	bool seen = false;
+	std::chrono::steady_clock::time_point last_arrival;
+
+	alignas(64) uint8_t frames[3][DMX_UNIVERSE_SIZE] = {};
+	uint16_t frame_length[3] = {};
+	TripleBufferIndex index;
+
+	// Written by the receive thread, read from anywhere.
+	std::atomic<uint64_t> packets{ 0 };
+	std::atomic<uint64_t> lost{ 0 }; // sequence numbers skipped
+	std::atomic<uint64_t> out_of_order{ 0 }; // arrived behind a later packet; not applied
+	std::atomic<uint64_t> duplicates{ 0 }; // same sequence number twice in a row
+	std::atomic<uint32_t> interval_usec{ 0 }; // smoothed time between packets
+	std::atomic<uint64_t> latency_total_usec{ 0 };
+	std::atomic<uint64_t> latency_samples{ 0 };
+	std::atomic<int64_t> latency_max_usec{ 0 };
+};
+
+struct DmxSimulatedUniverseStats {
+	uint64_t packets = 0;
+	uint64_t lost = 0;
+	uint64_t out_of_order = 0;
+	uint64_t duplicates = 0;
+	double rate_hz = 0.0;
+	double latency_avg_usec = -1.0; // -1 without latency stamps
+	double latency_max_usec = -1.0;
+};
+
+// A stand-in Art-Net node for load testing without hardware. It listens on
+// its own socket (normally on loopback), parses ArtDmx with the same parser
+// as ArtNetInput, and tracks per-universe packet rate, sequence gaps,
+// reordering and, when the sender stamps its frames, latency.
+class ArtNetNodeSimulator {
+	ArtNetSocket socket;
+	std::thread receiver;
+	std::atomic<bool> receiver_stop{ false };
+	bool running = false;
+
+	// Fixed while running, so the receive thread can look universes up without locking.
+	DmxUniverseArena<DmxSimulatedUniverse> universes;
+	std::vector<DmxSimulatedUniverse *> universe_list;
+	int latency_stamp_channel = -1;
+
+	std::atomic<bool> pending{ false };
+	std::atomic<uint64_t> packets_received{ 0 };
+	std::atomic<uint64_t> packets_ignored{ 0 }; // not ArtDmx, or for a universe not subscribed
+	std::atomic<uint64_t> syncs_received{ 0 };
+
+	void receiver_loop();
+
+public:
+	~ArtNetNodeSimulator();
+
+	// Subscribes a universe. Only allowed while stopped.
+	bool listen(uint16_t port_address);
+	void clear();
+
+	// Channel where senders put a latency stamp, or -1 to measure no latency.
+	// Only allowed while stopped.
+	bool set_latency_stamp_channel(int channel);
+	int get_latency_stamp_channel() const { return latency_stamp_channel; }
+
+	bool start(const ArtNetAddress &bind_address);
+	void stop();
+	bool is_running() const { return running; }
+
+	// Receive thread: handles one packet. Public so tests can feed packets directly.
+	void handle_packet(const uint8_t *packet, size_t size, std::chrono::steady_clock::time_point now);
+
+	// Reader: true if any universe has published a frame since the last call.
+	bool take_pending() { return pending.exchange(false, std::memory_order_acquire); }
+	const std::vector<DmxSimulatedUniverse *> &get_universes() const { return universe_list; }
+	DmxSimulatedUniverse *find_universe(uint16_t port_address) const { return universes.find(port_address); }
+	static void read_stats(const DmxSimulatedUniverse &universe, DmxSimulatedUniverseStats &r_stats);
+	void reset_stats();
+
+	uint64_t get_packets_received() const { return packets_received.load(std::memory_order_relaxed); }
+	uint64_t get_packets_ignored() const { return packets_ignored.load(std::memory_order_relaxed); }
+	uint64_t get_syncs_received() const { return syncs_received.load(std::memory_order_relaxed); }
+
+	// The clock latency stamps are taken on (the same one as ArtNetOutput::get_clock_usec()).
+	static int64_t get_clock_usec();
+	static void write_latency_stamp(uint8_t *dst, int64_t time_usec);
+	static int64_t read_latency_stamp(const uint8_t *src);
+};
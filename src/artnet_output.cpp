@@ -0,0 +1,1071 @@
+#include "artnet_output.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "artnet_log.h"
+#include "artnet_stats.h"
+#include "dmx_layer_stack.h"
+#include "dmx_recording.h"
+
+namespace {
+
+int64_t to_usec(std::chrono::steady_clock::time_point time) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+ArtNetOutput::ArtNetOutput() {
+	shards.push_back(std::make_unique<ArtNetSendShard>());
+	ArtNetTransport::get_singleton().register_output(this);
+}
+
+ArtNetOutput::~ArtNetOutput() {
+	ArtNetTransport::get_singleton().unregister_output(this);
+	close();
+	if (endpoint) {
+		endpoint->release_universes(this);
+	}
+}
+
+bool ArtNetOutput::configure(const std::string &bind_address, uint16_t port, const std::string &broadcast_address, uint16_t destination_port) {
+	if (opened) {
+		return false;
+	}
+	ArtNetAddress bind;
+	ArtNetAddress broadcast;
+	if (!ArtNetAddress::parse(bind_address, port, bind) || !ArtNetAddress::parse(broadcast_address, destination_port ? destination_port : port, broadcast)) {
+		return false;
+	}
+
+	// Universes created so far move over to the new endpoint with this output.
+	std::shared_ptr<ArtNetEndpoint> next = ArtNetTransport::get_singleton().get_endpoint(bind);
+	if (next != endpoint) {
+		for (DmxUniverseBuffer *universe : universe_list) {
+			if (!next->claim_universe(universe->port_address, this)) {
+				next->release_universes(this);
+				return false;
+			}
+		}
+		if (endpoint) {
+			endpoint->release_universes(this);
+		}
+		endpoint = next;
+	}
+	destination = broadcast;
+	build_shards();
+	return true;
+}
+
+bool ArtNetOutput::configure_shards(const std::vector<std::string> &bind_addresses, const std::vector<std::string> &broadcast_addresses, const std::vector<int> &cpus) {
+	if (opened || bind_addresses.size() >= MAX_SHARDS || broadcast_addresses.size() > bind_addresses.size() || cpus.size() > bind_addresses.size()) {
+		return false;
+	}
+	std::vector<ArtNetAddress> binds(bind_addresses.size());
+	std::vector<ArtNetAddress> destinations(bind_addresses.size());
+	for (size_t i = 0; i < bind_addresses.size(); i++) {
+		if (!ArtNetAddress::parse(bind_addresses[i], 0, binds[i])) {
+			return false;
+		}
+		if (i < broadcast_addresses.size() && !broadcast_addresses[i].empty() && !ArtNetAddress::parse(broadcast_addresses[i], 0, destinations[i])) {
+			return false;
+		}
+	}
+	shard_bind_addresses = std::move(binds);
+	shard_destinations = std::move(destinations);
+	shard_cpus = cpus;
+	shard_cpus.resize(shard_bind_addresses.size(), -1);
+	build_shards();
+	return true;
+}
+
+void ArtNetOutput::build_shards() {
+	shards.clear();
+	std::unique_ptr<ArtNetSendShard> primary = std::make_unique<ArtNetSendShard>();
+	primary->endpoint = endpoint;
+	primary->routes_endpoint = endpoint;
+	primary->destination = destination;
+	shards.push_back(std::move(primary));
+
+	// Shards take the output's ports; a repeated address gets the next socket on it.
+	for (size_t i = 0; endpoint && i < shard_bind_addresses.size(); i++) {
+		ArtNetAddress bind = shard_bind_addresses[i];
+		bind.port = endpoint->get_bind_address().port;
+		uint32_t index = 0;
+		for (const std::unique_ptr<ArtNetSendShard> &shard : shards) {
+			const ArtNetAddress &address = shard->endpoint->get_bind_address();
+			if (address.ip == bind.ip && address.port == bind.port) {
+				index++;
+			}
+		}
+		std::unique_ptr<ArtNetSendShard> shard = std::make_unique<ArtNetSendShard>();
+		shard->endpoint = ArtNetTransport::get_singleton().get_endpoint(bind, index);
+		shard->routes_endpoint = ArtNetTransport::get_singleton().get_endpoint(bind, 0);
+		shard->destination = destination;
+		if (shard_destinations[i].ip != 0) {
+			shard->destination.ip = shard_destinations[i].ip;
+		}
+		shard->cpu = shard_cpus[i];
+		shards.push_back(std::move(shard));
+	}
+	for (DmxUniverseBuffer *universe : universe_list) {
+		universe->shard = static_cast<uint8_t>(get_universe_shard(universe->port_address));
+	}
+}
+
+ArtNetShardStats ArtNetOutput::get_shard_stats(size_t index) const {
+	ArtNetShardStats stats;
+	if (index >= shards.size()) {
+		return stats;
+	}
+	const ArtNetSendShard &shard = *shards[index];
+	if (shard.endpoint) {
+		stats.bind_address = shard.endpoint->get_bind_address();
+	}
+	stats.destination = shard.destination;
+	stats.cpu = shard.cpu;
+	stats.pinned = shard.worker.is_pinned();
+	for (const DmxUniverseBuffer *universe : universe_list) {
+		if (universe->shard == index) {
+			stats.universes++;
+		}
+	}
+	stats.packets_sent = shard.packets_sent.load(std::memory_order_relaxed);
+	stats.bytes_sent = shard.bytes_sent.load(std::memory_order_relaxed);
+	stats.send_errors = shard.send_errors.load(std::memory_order_relaxed);
+	uint64_t passes = shard.passes.load(std::memory_order_relaxed);
+	if (passes > 0) {
+		stats.average_send_usec = shard.send_time_total_ns.load(std::memory_order_relaxed) / 1000.0 / static_cast<double>(passes);
+	}
+	stats.max_send_usec = shard.send_time_max_ns.load(std::memory_order_relaxed) / 1000.0;
+	return stats;
+}
+
+bool ArtNetOutput::open() {
+	if (opened) {
+		return true;
+	}
+	if (!endpoint || !endpoint->open()) {
+		return false;
+	}
+	for (size_t i = 1; i < shards.size(); i++) {
+		if (!shards[i]->endpoint->open()) {
+			while (--i > 0) {
+				shards[i]->endpoint->close();
+			}
+			endpoint->close();
+			return false;
+		}
+	}
+	for (size_t i = 1; i < shards.size(); i++) {
+		ArtNetSendShard *shard = shards[i].get();
+		shard->worker.start(shard->cpu, [this, shard]() {
+			shard->success = send_shard(*shard, shard->list.data(), shard->list.size(), shard->frame);
+		});
+	}
+	opened = true;
+	return true;
+}
+
+void ArtNetOutput::close() {
+	if (!opened) {
+		return;
+	}
+	stop_sacn();
+	stop_sender();
+	stop_discovery();
+	for (size_t i = 1; i < shards.size(); i++) {
+		shards[i]->worker.stop();
+		shards[i]->endpoint->close();
+	}
+	endpoint->close();
+	opened = false;
+}
+
+DmxUniverseBuffer *ArtNetOutput::get_universe(uint16_t port_address) {
+	if (port_address > ARTNET_MAX_PORT_ADDRESS) {
+		return nullptr;
+	}
+	DmxUniverseBuffer *universe = universes.find(port_address);
+	if (!universe) {
+		if (endpoint && !endpoint->claim_universe(port_address, this)) {
+			return nullptr;
+		}
+		universe = universes.insert(port_address);
+		universe->port_address = port_address;
+		universe->shard = static_cast<uint8_t>(get_universe_shard(port_address));
+		artnet_write_dmx_header(universe->artnet_header, 0, port_address, universe->length);
+		auto position = std::lower_bound(universe_list.begin(), universe_list.end(), port_address, [](const DmxUniverseBuffer *entry, uint16_t address) {
+			return entry->port_address < address;
+		});
+		universe_list.insert(position, universe);
+	}
+	return universe;
+}
+
+DmxUniverseBuffer *ArtNetOutput::find_universe(uint16_t port_address) const {
+	return universes.find(port_address);
+}
+
+bool ArtNetOutput::set_universe_data(uint16_t port_address, const uint8_t *data, size_t size) {
+	if (size == 0 || size > DMX_UNIVERSE_SIZE) {
+		return false;
+	}
+	DmxUniverseBuffer *universe = get_universe(port_address);
+	if (!universe) {
+		return false;
+	}
+	std::memcpy(universe->data, data, size);
+	std::memset(universe->data + size, 0, DMX_UNIVERSE_SIZE - size);
+	universe->length = artnet_dmx_length(size);
+	return true;
+}
+
+bool ArtNetOutput::bind_universes(const std::vector<uint16_t> &universes, std::vector<DmxUniverseBuffer *> &r_buffers, std::vector<uint8_t *> &r_slabs) {
+	r_buffers.resize(universes.size());
+	r_slabs.resize(universes.size());
+	for (size_t i = 0; i < universes.size(); i++) {
+		r_buffers[i] = get_universe(universes[i]);
+		if (!r_buffers[i]) {
+			return false;
+		}
+		r_slabs[i] = r_buffers[i]->data;
+	}
+	return true;
+}
+
+void ArtNetOutput::extend_lengths(const std::vector<DmxUniverseBuffer *> &buffers, const std::vector<uint16_t> &ends) {
+	for (size_t i = 0; i < buffers.size(); i++) {
+		if (ends[i] > buffers[i]->length) {
+			buffers[i]->length = artnet_dmx_length(ends[i]);
+		}
+	}
+}
+
+bool ArtNetOutput::send_universe_range(uint16_t first_universe, const uint8_t *data, size_t size) {
+	if (size == 0 || size % DMX_UNIVERSE_SIZE != 0) {
+		return false;
+	}
+	size_t count = size / DMX_UNIVERSE_SIZE;
+	if (first_universe + count - 1 > ARTNET_MAX_PORT_ADDRESS) {
+		return false;
+	}
+
+	batch.clear();
+	for (size_t i = 0; i < count; i++) {
+		DmxUniverseBuffer *universe = get_universe(static_cast<uint16_t>(first_universe + i));
+		if (!universe) {
+			return false;
+		}
+		batch.push_back(universe);
+	}
+	for (size_t i = 0; i < count; i++) {
+		std::memcpy(batch[i]->data, data + i * DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE);
+		batch[i]->length = DMX_UNIVERSE_SIZE;
+	}
+	return send_universes(batch.data(), batch.size());
+}
+
+bool ArtNetOutput::send_universe_list(const int32_t *port_addresses, size_t count, const uint8_t *data, size_t size) {
+	if (count == 0 || size != count * DMX_UNIVERSE_SIZE) {
+		return false;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (port_addresses[i] < 0 || port_addresses[i] > ARTNET_MAX_PORT_ADDRESS) {
+			return false;
+		}
+	}
+
+	batch.clear();
+	for (size_t i = 0; i < count; i++) {
+		DmxUniverseBuffer *universe = get_universe(static_cast<uint16_t>(port_addresses[i]));
+		if (!universe) {
+			return false;
+		}
+		batch.push_back(universe);
+	}
+	for (size_t i = 0; i < count; i++) {
+		std::memcpy(batch[i]->data, data + i * DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE);
+		batch[i]->length = DMX_UNIVERSE_SIZE;
+	}
+	return send_universes(batch.data(), batch.size());
+}
+
+bool ArtNetOutput::send_universe(DmxUniverseBuffer &universe) {
+	DmxUniverseBuffer *list[1] = { &universe };
+	return send_universes(list, 1);
+}
+
+bool ArtNetOutput::send_universes(DmxUniverseBuffer *const *list, size_t count) {
+	if (!layers) {
+		return send_slabs(list, count);
+	}
+	// Layers are merged over the slabs only while they are sent or
+	// committed, so the slabs keep what their writers put there.
+	layers->overlay(list, count);
+	bool success = send_slabs(list, count);
+	layers->restore();
+	return success;
+}
+
+bool ArtNetOutput::send_slabs(DmxUniverseBuffer *const *list, size_t count) {
+	if (recorder) {
+		recorder->begin_frame(get_clock_usec());
+		for (size_t i = 0; i < count; i++) {
+			// Scheduled universes are not sent from the slab, so it is not what went out.
+			if (!list[i]->scheduled) {
+				recorder->add_universe(list[i]->port_address, list[i]->data, list[i]->length);
+			}
+		}
+		recorder->end_frame();
+	}
+	if (sender_running) {
+		commit_universes(list, count);
+		return true;
+	}
+	if (!enabled) {
+		return true;
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	sync_due.clear();
+	for (size_t i = 0; i < count; i++) {
+		if (should_send(*list[i], -1, true, now)) {
+			sync_due.push_back(list[i]);
+		}
+	}
+	return emit(sync_due.data(), sync_due.size(), -1, true);
+}
+
+bool ArtNetOutput::send_all() {
+	return send_universes(universe_list.data(), universe_list.size());
+}
+
+void ArtNetOutput::commit_universes(DmxUniverseBuffer *const *list, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		if (!list[i]->scheduled) {
+			list[i]->generation++;
+		}
+	}
+
+	// Bring the whole back slot up to date so the thread always sees a complete
+	// frame. Universes that were not part of this commit carry over their last
+	// committed snapshot, not whatever has been written to them since.
+	uint8_t back = frame_index.back();
+	frame_universes[back].assign(universe_list.begin(), universe_list.end());
+	for (DmxUniverseBuffer *universe : universe_list) {
+		if (universe->frame_generation[back] == universe->generation) {
+			continue;
+		}
+		bool committed_now = universe->frame_generation[universe->committed_frame] != universe->generation;
+		const uint8_t *source = committed_now ? universe->data : universe->frames[universe->committed_frame];
+		uint16_t length = committed_now ? universe->length : universe->frame_length[universe->committed_frame];
+		std::memcpy(universe->frames[back], source, DMX_UNIVERSE_SIZE);
+		universe->frame_length[back] = length;
+		universe->frame_generation[back] = universe->generation;
+		universe->committed_frame = back;
+	}
+	frame_index.publish();
+}
+
+bool ArtNetOutput::should_send(DmxUniverseBuffer &universe, int frame, bool requested, std::chrono::steady_clock::time_point now) {
+	bool sent_before = universe.last_sent != std::chrono::steady_clock::time_point();
+	bool keep_alive_due = sent_before && now - universe.last_sent >= std::chrono::microseconds(keep_alive_usec.load(std::memory_order_relaxed));
+	if (!requested && !keep_alive_due && !universe.resend) {
+		return false;
+	}
+
+	// The delta and last-sent state is recorded before the packet goes out;
+	// the send path sets resend for a universe whose packet then fails.
+	const uint8_t *payload = frame < 0 ? universe.data : universe.frames[frame];
+	uint16_t length = frame < 0 ? universe.length : universe.frame_length[frame];
+	if (delta_enabled.load(std::memory_order_relaxed)) {
+		if (!keep_alive_due && !universe.resend && sent_before && length == universe.last_sent_length && std::memcmp(payload, universe.last_sent_data, length) == 0) {
+			packets_skipped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		std::memcpy(universe.last_sent_data, payload, length);
+		universe.last_sent_length = length;
+	}
+	universe.resend = false;
+	universe.last_sent = now;
+	universe.last_sent_usec.store(to_usec(now), std::memory_order_relaxed);
+	return true;
+}
+
+bool ArtNetOutput::emit(DmxUniverseBuffer *const *list, size_t count, int frame, bool latch) {
+	if (!enabled) {
+		return true;
+	}
+	if (!opened) {
+		return false;
+	}
+	bool success = true;
+	if (artnet_enabled.load(std::memory_order_relaxed)) {
+		success = emit_artnet(list, count, frame, latch);
+	}
+	if (sacn_running.load(std::memory_order_relaxed) && !sacn.emit(list, count, frame, latch)) {
+		success = false;
+	}
+	return success;
+}
+
+bool ArtNetOutput::emit_artnet(DmxUniverseBuffer *const *list, size_t count, int frame, bool latch) {
+	bool success = true;
+	if (shards.size() == 1) {
+		success = send_shard(*shards[0], list, count, frame);
+	} else {
+		// Each worker sends its own universes, so no universe is touched by two
+		// threads; the pass ends when the slowest shard is done.
+		for (const std::unique_ptr<ArtNetSendShard> &shard : shards) {
+			shard->list.clear();
+		}
+		for (size_t i = 0; i < count; i++) {
+			shards[list[i]->shard]->list.push_back(list[i]);
+		}
+		for (size_t i = 1; i < shards.size(); i++) {
+			if (!shards[i]->list.empty()) {
+				shards[i]->frame = frame;
+				shards[i]->worker.post();
+			}
+		}
+		ArtNetSendShard &primary = *shards[0];
+		if (!primary.list.empty()) {
+			success = send_shard(primary, primary.list.data(), primary.list.size(), frame);
+		}
+		for (size_t i = 1; i < shards.size(); i++) {
+			if (!shards[i]->list.empty()) {
+				shards[i]->worker.wait();
+				success = success && shards[i]->success;
+			}
+		}
+	}
+
+	// ArtSync goes to the broadcast address even in unicast mode, so every
+	// node that received part of the frame latches it. Each shard that sent
+	// part of the frame syncs its own network.
+	if (latch && count > 0 && art_sync_enabled.load(std::memory_order_relaxed)) {
+		uint8_t sync[ARTNET_SYNC_SIZE];
+		artnet_write_sync(sync);
+		for (const std::unique_ptr<ArtNetSendShard> &shard : shards) {
+			if (shards.size() > 1 && shard->list.empty()) {
+				continue;
+			}
+			if (shard->endpoint->get_socket().send_to(shard->destination, sync, sizeof(sync))) {
+				syncs_sent.fetch_add(1, std::memory_order_relaxed);
+			} else {
+				success = false;
+			}
+		}
+	}
+	return success;
+}
+
+bool ArtNetOutput::send_shard(ArtNetSendShard &shard, DmxUniverseBuffer *const *list, size_t count, int frame) {
+	ArtNetSocket &socket = shard.endpoint->get_socket();
+
+	std::shared_ptr<const ArtNetRoutingTable> routes;
+	if (send_mode.load(std::memory_order_relaxed) == SEND_MODE_UNICAST) {
+		routes = shard.routes_endpoint->get_routing_table();
+	}
+
+	ArtNetDatagram datagrams[ArtNetSocket::MAX_BATCH];
+	bool datagram_sent[ArtNetSocket::MAX_BATCH];
+	DmxUniverseBuffer *datagram_universe[ArtNetSocket::MAX_BATCH];
+	size_t datagram_count = 0;
+	bool success = true;
+	std::chrono::steady_clock::time_point pass_start = std::chrono::steady_clock::now();
+
+	auto flush = [&]() {
+		int error = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		size_t sent = socket.send_batch(datagrams, datagram_count, &error, datagram_sent);
+		uint64_t latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		size_t bytes = 0;
+		for (size_t i = 0; i < datagram_count; i++) {
+			if (datagram_sent[i]) {
+				bytes += datagrams[i].header_size + datagrams[i].payload_size;
+			} else {
+				datagram_universe[i]->resend = true;
+			}
+		}
+		ArtNetStats::get_singleton().record_send(datagram_count, sent, bytes, latency, error);
+		packets_sent.fetch_add(sent, std::memory_order_relaxed);
+		shard.packets_sent.fetch_add(sent, std::memory_order_relaxed);
+		shard.bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+		if (sent != datagram_count) {
+			shard.send_errors.fetch_add(datagram_count - sent, std::memory_order_relaxed);
+			// Report the first failure of a run as an error, the rest only at debug level.
+			ArtNetLog::get_singleton().write(shard.send_failing ? ARTNET_LOG_DEBUG : ARTNET_LOG_ERROR, "send failed for %lld of %lld packets (socket error %lld)", static_cast<long long>(datagram_count - sent), static_cast<long long>(datagram_count), error);
+			shard.send_failing = true;
+			success = false;
+		} else if (shard.send_failing) {
+			ArtNetLog::get_singleton().write(ARTNET_LOG_INFO, "sending recovered");
+			shard.send_failing = false;
+		}
+		datagram_count = 0;
+	};
+
+	for (size_t i = 0; i < count; i++) {
+		DmxUniverseBuffer &universe = *list[i];
+		const ArtNetAddress *destinations = &shard.destination;
+		size_t destination_count = 1;
+		if (routes) {
+			const std::vector<ArtNetAddress> *subscribers = routes->find(universe.port_address);
+			if (subscribers && !subscribers->empty()) {
+				destinations = subscribers->data();
+				destination_count = std::min(subscribers->size(), ArtNetSocket::MAX_BATCH);
+			}
+		}
+		if (datagram_count + destination_count > ArtNetSocket::MAX_BATCH) {
+			flush();
+		}
+
+		uint16_t length = frame < 0 ? universe.length : universe.frame_length[frame];
+		universe.sequence = artnet_next_sequence(universe.sequence);
+		uint8_t *header = universe.artnet_header;
+		artnet_patch_dmx_header(header, universe.sequence, length);
+
+		for (size_t d = 0; d < destination_count; d++) {
+			datagram_universe[datagram_count] = &universe;
+			ArtNetDatagram &datagram = datagrams[datagram_count++];
+			datagram.destination = &destinations[d];
+			datagram.header = header;
+			datagram.header_size = ARTNET_DMX_HEADER_SIZE;
+			datagram.payload = frame < 0 ? universe.data : universe.frames[frame];
+			datagram.payload_size = length;
+		}
+	}
+	if (datagram_count > 0) {
+		flush();
+	}
+
+	uint64_t elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - pass_start).count());
+	shard.passes.fetch_add(1, std::memory_order_relaxed);
+	shard.send_time_total_ns.fetch_add(elapsed, std::memory_order_relaxed);
+	if (elapsed > shard.send_time_max_ns.load(std::memory_order_relaxed)) {
+		shard.send_time_max_ns.store(elapsed, std::memory_order_relaxed);
+	}
+	return success;
+}
+
+bool ArtNetOutput::start_sender(double rate_hz, bool p_realtime_priority) {
+	if (sender_running || !opened) {
+		return false;
+	}
+	rate_hz = std::clamp(rate_hz, MIN_REFRESH_RATE, MAX_REFRESH_RATE);
+	refresh_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate_hz));
+
+	// Everything set so far becomes the first committed frame.
+	frame_index.reset();
+	for (std::vector<DmxUniverseBuffer *> &frame_set : frame_universes) {
+		frame_set.clear();
+	}
+	for (DmxUniverseBuffer *universe : universe_list) {
+		std::fill(std::begin(universe->frame_generation), std::end(universe->frame_generation), 0);
+		universe->committed_frame = 0;
+		universe->sent_generation = 0;
+		universe->scheduled = false;
+		universe->scheduled_latest = false;
+		universe->fade_committed = false;
+	}
+	commit_universes(universe_list.data(), universe_list.size());
+
+	schedule.reserve(schedule_capacity);
+	scheduled_due.reserve(schedule_capacity);
+	last_scheduled_usec = 0;
+	fades.reserve(FADE_QUEUE_CAPACITY);
+
+	next_tick = std::chrono::steady_clock::now() + refresh_period;
+	sender_running = true;
+	realtime_priority = p_realtime_priority;
+	for (const std::unique_ptr<ArtNetSendShard> &shard : shards) {
+		shard->worker.set_realtime(realtime_priority);
+	}
+	ArtNetTransport::get_singleton().add_output(this, realtime_priority);
+	return true;
+}
+
+void ArtNetOutput::stop_sender() {
+	if (!sender_running) {
+		return;
+	}
+	ArtNetTransport::get_singleton().remove_output(this);
+	sender_running = false;
+
+	// Frames still queued are dropped; the universes go back to plain commits.
+	schedule.reset();
+	last_scheduled_usec = 0;
+	for (DmxUniverseBuffer *universe : universe_list) {
+		universe->scheduled = false;
+	}
+	fades.reset();
+}
+
+bool ArtNetOutput::is_sender_running() {
+	return sender_running;
+}
+
+void ArtNetOutput::set_keep_alive_interval(double seconds) {
+	keep_alive_usec = static_cast<int64_t>(std::max(seconds, 0.0) * 1000000.0);
+}
+
+double ArtNetOutput::get_keep_alive_interval() const {
+	return keep_alive_usec / 1000000.0;
+}
+
+int64_t ArtNetOutput::get_clock_usec() {
+	return to_usec(std::chrono::steady_clock::now());
+}
+
+bool ArtNetOutput::schedule_universe(uint16_t port_address, const uint8_t *data, size_t size, int64_t target_usec) {
+	if (size == 0 || size > DMX_UNIVERSE_SIZE) {
+		return false;
+	}
+	DmxUniverseBuffer *universe = get_universe(port_address);
+	if (!universe) {
+		return false;
+	}
+	DmxUniverseBuffer *list[1] = { universe };
+	return schedule_universes(list, 1, data, 0, size, target_usec);
+}
+
+bool ArtNetOutput::schedule_universe_range(uint16_t first_universe, const uint8_t *data, size_t size, int64_t target_usec) {
+	if (size == 0 || size % DMX_UNIVERSE_SIZE != 0) {
+		return false;
+	}
+	size_t count = size / DMX_UNIVERSE_SIZE;
+	if (first_universe + count - 1 > ARTNET_MAX_PORT_ADDRESS) {
+		return false;
+	}
+
+	batch.clear();
+	for (size_t i = 0; i < count; i++) {
+		DmxUniverseBuffer *universe = get_universe(static_cast<uint16_t>(first_universe + i));
+		if (!universe) {
+			return false;
+		}
+		batch.push_back(universe);
+	}
+	return schedule_universes(batch.data(), batch.size(), data, DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, target_usec);
+}
+
+bool ArtNetOutput::schedule_universes(DmxUniverseBuffer *const *list, size_t count, const uint8_t *data, size_t stride, size_t size, int64_t target_usec) {
+	if (!sender_running || target_usec < last_scheduled_usec) {
+		return false;
+	}
+	// All or nothing: a frame split across a full queue would play half a look.
+	if (!schedule.prepare(count - 1)) {
+		return false;
+	}
+	uint16_t length = artnet_dmx_length(size);
+	for (size_t i = 0; i < count; i++) {
+		DmxScheduledFrame &frame = *schedule.prepare(i);
+		frame.target_usec = target_usec;
+		frame.universe = list[i];
+		frame.generation = list[i]->generation;
+		frame.length = length;
+		std::memcpy(frame.data, data + i * stride, size);
+		std::memset(frame.data + size, 0, length - size);
+		list[i]->scheduled = true;
+	}
+	schedule.push(count);
+	last_scheduled_usec = target_usec;
+
+	// The new frame may be due before the deadline the sender is sleeping towards.
+	ArtNetTransport::get_singleton().wake_sender();
+	return true;
+}
+
+void ArtNetOutput::clear_schedule() {
+	if (sender_running) {
+		schedule.request_clear();
+	} else {
+		schedule.reset();
+	}
+	last_scheduled_usec = 0;
+	for (DmxUniverseBuffer *universe : universe_list) {
+		universe->scheduled = false;
+	}
+}
+
+DmxUniverseBuffer *ArtNetOutput::get_fade_universe(uint16_t port_address, uint16_t channel, size_t count) {
+	if (!sender_running || count == 0 || channel + count > DMX_UNIVERSE_SIZE) {
+		return nullptr;
+	}
+	return get_universe(port_address);
+}
+
+bool ArtNetOutput::fade_channels(uint16_t port_address, uint16_t channel, const uint8_t *targets, size_t count, double duration_seconds, DmxFadeCurve curve) {
+	if (curve < 0 || curve >= DMX_FADE_CURVE_MAX) {
+		return false;
+	}
+	DmxUniverseBuffer *universe = get_fade_universe(port_address, channel, count);
+	if (!universe) {
+		return false;
+	}
+	int64_t duration_usec = static_cast<int64_t>(std::max(duration_seconds, 0.0) * 1000000.0);
+	return fades.fade(universe, channel, targets, static_cast<uint16_t>(count), get_clock_usec(), duration_usec, curve);
+}
+
+bool ArtNetOutput::fade_channel_range(uint16_t port_address, uint16_t channel, size_t count, uint8_t target, double duration_seconds, DmxFadeCurve curve) {
+	if (curve < 0 || curve >= DMX_FADE_CURVE_MAX) {
+		return false;
+	}
+	DmxUniverseBuffer *universe = get_fade_universe(port_address, channel, count);
+	if (!universe) {
+		return false;
+	}
+	int64_t duration_usec = static_cast<int64_t>(std::max(duration_seconds, 0.0) * 1000000.0);
+	return fades.fill(universe, channel, target, static_cast<uint16_t>(count), get_clock_usec(), duration_usec, curve);
+}
+
+bool ArtNetOutput::release_fades(uint16_t port_address, uint16_t channel, size_t count) {
+	DmxUniverseBuffer *universe = get_fade_universe(port_address, channel, count);
+	if (!universe) {
+		return false;
+	}
+	return fades.release(universe, channel, static_cast<uint16_t>(count));
+}
+
+bool ArtNetOutput::release_all_fades() {
+	if (!sender_running) {
+		return false;
+	}
+	return fades.release_all();
+}
+
+bool ArtNetOutput::set_schedule_capacity(size_t frames) {
+	if (sender_running || frames == 0 || frames > MAX_SCHEDULE_CAPACITY) {
+		return false;
+	}
+	schedule_capacity = frames;
+	return true;
+}
+
+void ArtNetOutput::set_late_frame_tolerance(double seconds) {
+	late_tolerance_usec = static_cast<int64_t>(std::max(seconds, 0.0) * 1000000.0);
+}
+
+double ArtNetOutput::get_late_frame_tolerance() const {
+	return late_tolerance_usec / 1000000.0;
+}
+
+double ArtNetOutput::get_average_timing_error_usec() const {
+	uint64_t sent = scheduled_sent.load(std::memory_order_relaxed);
+	if (sent == 0) {
+		return 0.0;
+	}
+	return static_cast<double>(timing_error_total_usec.load(std::memory_order_relaxed)) / static_cast<double>(sent);
+}
+
+bool ArtNetOutput::start_discovery(double poll_interval_seconds) {
+	if (discovery_running || !opened) {
+		return false;
+	}
+	// One discovery per address: repeated addresses share the first socket's routes.
+	for (size_t i = 0; i < shards.size(); i++) {
+		ArtNetSendShard &shard = *shards[i];
+		if (shard.endpoint == shard.routes_endpoint && !shard.endpoint->start_discovery(shard.destination, poll_interval_seconds)) {
+			while (i-- > 0) {
+				if (shards[i]->endpoint == shards[i]->routes_endpoint) {
+					shards[i]->endpoint->stop_discovery();
+				}
+			}
+			return false;
+		}
+	}
+	discovery_running = true;
+	return true;
+}
+
+void ArtNetOutput::stop_discovery() {
+	if (!discovery_running) {
+		return;
+	}
+	for (const std::unique_ptr<ArtNetSendShard> &shard : shards) {
+		if (shard->endpoint == shard->routes_endpoint) {
+			shard->endpoint->stop_discovery();
+		}
+	}
+	discovery_running = false;
+}
+
+std::shared_ptr<const ArtNetRoutingTable> ArtNetOutput::get_routing_table(size_t shard) const {
+	if (shard >= shards.size() || !shards[shard]->routes_endpoint) {
+		return std::make_shared<const ArtNetRoutingTable>();
+	}
+	return shards[shard]->routes_endpoint->get_routing_table();
+}
+
+std::vector<std::shared_ptr<const ArtNetNodeTable>> ArtNetOutput::get_node_tables() const {
+	std::vector<std::shared_ptr<const ArtNetNodeTable>> tables;
+	for (const std::unique_ptr<ArtNetSendShard> &shard : shards) {
+		if (shard->endpoint && shard->endpoint == shard->routes_endpoint) {
+			tables.push_back(shard->endpoint->get_node_table());
+		}
+	}
+	return tables;
+}
+
+double ArtNetOutput::get_send_age(uint16_t port_address) const {
+	DmxUniverseBuffer *universe = find_universe(port_address);
+	if (!universe) {
+		return -1.0;
+	}
+	int64_t last = universe->last_sent_usec.load(std::memory_order_relaxed);
+	if (last == 0) {
+		return -1.0;
+	}
+	return (to_usec(std::chrono::steady_clock::now()) - last) / 1000000.0;
+}
+
+double ArtNetOutput::get_oldest_send_age() const {
+	int64_t oldest = 0;
+	for (const DmxUniverseBuffer *universe : universe_list) {
+		int64_t last = universe->last_sent_usec.load(std::memory_order_relaxed);
+		if (last != 0 && (oldest == 0 || last < oldest)) {
+			oldest = last;
+		}
+	}
+	if (oldest == 0) {
+		return -1.0;
+	}
+	return (to_usec(std::chrono::steady_clock::now()) - oldest) / 1000000.0;
+}
+
+void ArtNetOutput::reset_counters() {
+	packets_sent = 0;
+	packets_skipped = 0;
+	syncs_sent = 0;
+	scheduled_sent = 0;
+	scheduled_dropped = 0;
+	scheduled_late = 0;
+	timing_error_total_usec = 0;
+	timing_error_max_usec = 0;
+	for (const std::unique_ptr<ArtNetSendShard> &shard : shards) {
+		shard->packets_sent = 0;
+		shard->bytes_sent = 0;
+		shard->send_errors = 0;
+		shard->passes = 0;
+		shard->send_time_total_ns = 0;
+		shard->send_time_max_ns = 0;
+	}
+	sacn.reset_counters();
+}
+
+bool ArtNetOutput::pause_sender() {
+	if (!sender_running) {
+		return false;
+	}
+	// Waits out a tick in progress; next_tick is kept, so the schedule resumes where it was.
+	ArtNetTransport::get_singleton().remove_output(this);
+	return true;
+}
+
+void ArtNetOutput::resume_sender(bool paused) {
+	if (paused) {
+		ArtNetTransport::get_singleton().add_output(this, realtime_priority);
+	}
+}
+
+bool ArtNetOutput::configure_sacn(const std::string &bind_address, const std::string &source_name, int universe_offset, uint16_t destination_port) {
+	if (sacn_running) {
+		return false;
+	}
+	return sacn.configure(bind_address, source_name, universe_offset, destination_port);
+}
+
+bool ArtNetOutput::start_sacn() {
+	if (sacn_running || !opened) {
+		return false;
+	}
+	bool paused = pause_sender();
+	bool started = sacn.open();
+	sacn_running = started;
+	resume_sender(paused);
+	return started;
+}
+
+void ArtNetOutput::stop_sacn() {
+	if (!sacn_running) {
+		return;
+	}
+	bool paused = pause_sender();
+	sacn_running = false;
+	sacn.close(universe_list.data(), universe_list.size());
+	resume_sender(paused);
+}
+
+void ArtNetOutput::tick(std::chrono::steady_clock::time_point now) {
+	if (now >= next_tick) {
+		send_periodic(now);
+	}
+	play_schedule();
+}
+
+std::chrono::steady_clock::time_point ArtNetOutput::get_next_scheduled() const {
+	if (schedule.clear_pending()) {
+		return std::chrono::steady_clock::time_point();
+	}
+	const DmxScheduledFrame *frame = schedule.front();
+	if (!frame) {
+		return std::chrono::steady_clock::time_point::max();
+	}
+	return std::chrono::steady_clock::time_point(std::chrono::microseconds(frame->target_usec));
+}
+
+void ArtNetOutput::play_schedule() {
+	schedule.handle_clear();
+
+	// Sampled after the periodic pass so the measured error covers it too.
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	int64_t now_usec = to_usec(now);
+	int64_t tolerance = late_tolerance_usec.load(std::memory_order_relaxed);
+	bool drop_late = late_frame_policy.load(std::memory_order_relaxed) == LATE_FRAME_DROP;
+	bool active = enabled.load(std::memory_order_relaxed);
+
+	// Every frame that is due goes out in one pass; when several frames for
+	// one universe are due at once, only the newest is sent.
+	scheduled_due.clear();
+	uint64_t played = 0;
+	for (const DmxScheduledFrame *frame = schedule.front(); frame && frame->target_usec <= now_usec; frame = schedule.front()) {
+		int64_t late = now_usec - frame->target_usec;
+		if (!active || (drop_late && late > tolerance)) {
+			if (active) {
+				ArtNetLog::get_singleton().write(ARTNET_LOG_DEBUG, "scheduled frame for universe %lld dropped, %lld us late", static_cast<long long>(frame->universe->port_address), static_cast<long long>(late));
+			}
+			scheduled_dropped.fetch_add(1, std::memory_order_relaxed);
+			schedule.pop();
+			continue;
+		}
+		if (late > tolerance) {
+			scheduled_late.fetch_add(1, std::memory_order_relaxed);
+		}
+		timing_error_total_usec.fetch_add(static_cast<uint64_t>(late), std::memory_order_relaxed);
+		uint64_t error = static_cast<uint64_t>(late);
+		uint64_t max = timing_error_max_usec.load(std::memory_order_relaxed);
+		if (error > max) {
+			timing_error_max_usec.store(error, std::memory_order_relaxed);
+		}
+
+		DmxUniverseBuffer *universe = frame->universe;
+		std::memcpy(universe->frames[DmxUniverseBuffer::SCHEDULED_FRAME], frame->data, frame->length);
+		universe->frame_length[DmxUniverseBuffer::SCHEDULED_FRAME] = frame->length;
+		universe->sent_generation = std::max(universe->sent_generation, frame->generation);
+		if (!universe->scheduled_due) {
+			universe->scheduled_due = true;
+			scheduled_due.push_back(universe);
+		}
+		played++;
+		schedule.pop();
+	}
+	if (played == 0) {
+		return;
+	}
+
+	size_t count = 0;
+	for (DmxUniverseBuffer *universe : scheduled_due) {
+		universe->scheduled_due = false;
+		universe->scheduled_latest = true;
+		if (should_send(*universe, DmxUniverseBuffer::SCHEDULED_FRAME, true, now)) {
+			scheduled_due[count++] = universe;
+		}
+	}
+	if (count > 0) {
+		emit(scheduled_due.data(), count, DmxUniverseBuffer::SCHEDULED_FRAME, true);
+	}
+	scheduled_sent.fetch_add(played, std::memory_order_relaxed);
+}
+
+bool ArtNetOutput::collect_fades(uint8_t front, std::chrono::steady_clock::time_point now) {
+	fade_due.clear();
+	bool latch = false;
+	for (DmxFadeState *state : fades.get_states()) {
+		DmxUniverseBuffer *universe = state->universe;
+		if (universe->scheduled_latest) {
+			continue;
+		}
+		uint8_t *out = universe->frames[DmxUniverseBuffer::FADE_FRAME];
+		const uint8_t *base = universe->frames[front];
+		dmx_fade_merge(out, base, state->value, state->held, state->extent);
+		std::memcpy(out + state->extent, base + state->extent, DMX_UNIVERSE_SIZE - state->extent);
+		uint16_t length = universe->frame_length[front];
+		if (state->extent > length) {
+			length = artnet_dmx_length(state->extent);
+		}
+		universe->frame_length[DmxUniverseBuffer::FADE_FRAME] = length;
+
+		bool requested = state->changed || universe->fade_committed;
+		state->changed = false;
+		universe->fade_committed = false;
+		if (should_send(*universe, DmxUniverseBuffer::FADE_FRAME, requested, now)) {
+			fade_due.push_back(universe);
+			latch = latch || requested;
+		}
+	}
+	return latch;
+}
+
+void ArtNetOutput::send_periodic(std::chrono::steady_clock::time_point now) {
+	// Deadlines advance by a fixed period from the previous deadline rather
+	// than from when the last pass finished, so send time does not drift.
+	if (now - next_tick > refresh_period) {
+		// More than a whole tick late: skip the missed ticks instead of bursting.
+		ArtNetLog::get_singleton().write(ARTNET_LOG_INFO, "sender tick %lld us late, skipping missed ticks", std::chrono::duration_cast<std::chrono::microseconds>(now - next_tick).count());
+		next_tick = now;
+		ArtNetStats::get_singleton().record_overrun();
+	}
+	next_tick += refresh_period;
+	if (!enabled) {
+		return;
+	}
+
+	frame_index.acquire();
+	uint8_t front = frame_index.front();
+	fades.update(to_usec(now), front);
+
+	due.clear();
+	scheduled_keep_alive.clear();
+	bool latch = false;
+	for (DmxUniverseBuffer *universe : frame_universes[front]) {
+		// Generations only grow, and a scheduled frame marks every commit made
+		// before it was queued as sent.
+		bool committed = universe->frame_generation[front] > universe->sent_generation;
+		if (committed) {
+			universe->sent_generation = universe->frame_generation[front];
+			universe->scheduled_latest = false;
+		} else if (universe->scheduled_latest) {
+			// Keep-alives repeat what the schedule sent last, not the stale commit.
+			if (should_send(*universe, DmxUniverseBuffer::SCHEDULED_FRAME, false, now)) {
+				scheduled_keep_alive.push_back(universe);
+			}
+			continue;
+		}
+		if (universe->fade) {
+			// Sent from FADE_FRAME by collect_fades().
+			universe->fade_committed = universe->fade_committed || committed;
+			continue;
+		}
+		if (should_send(*universe, front, committed, now)) {
+			due.push_back(universe);
+			latch = latch || committed;
+		}
+	}
+	bool fade_latch = collect_fades(front, now);
+	// One ArtSync (and sACN sync) after the last packet of the pass, and none
+	// for a pass of keep-alives only. Keep-alives repeat what receivers
+	// already show, so they go first and never latch.
+	if (!scheduled_keep_alive.empty()) {
+		emit(scheduled_keep_alive.data(), scheduled_keep_alive.size(), DmxUniverseBuffer::SCHEDULED_FRAME, false);
+	}
+	if (!due.empty()) {
+		emit(due.data(), due.size(), front, latch && fade_due.empty());
+	}
+	if (!fade_due.empty()) {
+		emit(fade_due.data(), fade_due.size(), DmxUniverseBuffer::FADE_FRAME, latch || fade_latch);
+	}
+	fades.prune();
+	ArtNetLog::get_singleton().write(ARTNET_LOG_DEBUG, "tick: %lld of %lld universes due", static_cast<long long>(due.size()), static_cast<long long>(frame_universes[front].size()));
+}
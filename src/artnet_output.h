@@ -0,0 +1,390 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "artnet_discovery.h"
+#include "artnet_protocol.h"
+#include "artnet_socket.h"
+#include "artnet_transport.h"
+#include "dmx_fade_engine.h"
+#include "dmx_schedule_queue.h"
+#include "dmx_universe_arena.h"
+#include "sacn_output.h"
+#include "triple_buffer.h"
+
+class DmxLayerStack;
+class DmxRecordingWriter;
+
+// Stable per-universe storage. The data slab never moves once created, so
+// handles can write channels in place and packets are sent straight from it.
+// When the sender thread runs, commits snapshot the slab into one of three
+// frame slots that are handed to the thread through a TripleBufferIndex. A
+// fourth slot holds the last scheduled frame the thread played out, and a
+// fifth the committed frame with the fade engine's channels merged over it.
+struct DmxUniverseBuffer {
+	static constexpr int SCHEDULED_FRAME = 3;
+	static constexpr int FADE_FRAME = 4;
+
+	alignas(64) uint8_t data[DMX_UNIVERSE_SIZE] = {};
+	uint16_t port_address = 0;
+	uint16_t length = DMX_UNIVERSE_SIZE;
+	uint64_t generation = 0; // bumped by the writer on every commit
+	bool scheduled = false; // writer-owned: driven by the schedule queue, commits skip it
+	uint8_t shard = 0; // send shard, fixed while the output is open
+
+	alignas(64) uint8_t frames[5][DMX_UNIVERSE_SIZE] = {};
+	uint16_t frame_length[5] = { DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE };
+	uint64_t frame_generation[3] = {};
+	uint8_t committed_frame = 0; // slot holding the latest committed snapshot
+
+	// Owned by whichever thread sends: the caller of send_dmx() or the shared sender thread.
+	// Packet headers are built once and only their per-packet fields are
+	// patched before each send; payloads go out straight from the slab or frame.
+	uint8_t artnet_header[ARTNET_DMX_HEADER_SIZE] = {};
+	uint8_t sacn_header[SACN_DATA_HEADER_SIZE] = {};
+	uint32_t sacn_header_epoch = 0; // SacnOutput configuration the sACN header was built for
+	uint8_t sequence = 0;
+	uint8_t sacn_sequence = 0;
+	uint64_t sent_generation = 0;
+	std::chrono::steady_clock::time_point last_sent;
+	std::atomic<int64_t> last_sent_usec{ 0 }; // copy of last_sent readable from any thread, 0 if never sent
+	alignas(64) uint8_t last_sent_data[DMX_UNIVERSE_SIZE] = {};
+	uint16_t last_sent_length = 0;
+	bool resend = false; // a packet of the last send failed: send again on the next pass, even if unchanged
+	bool scheduled_latest = false; // keep-alives resend SCHEDULED_FRAME
+	bool scheduled_due = false; // already collected in the current playout pass
+	DmxFadeState *fade = nullptr; // sender thread: channels held by the fade engine, if any
+	bool fade_committed = false; // sender thread: a commit arrived that the fade pass has not sent
+};
+
+// One socket of an output's Art-Net send path. Shard 0 is the output's own
+// endpoint and sends on the thread running the pass; every further shard
+// has a worker thread that sends its part of the pass in parallel.
+struct ArtNetSendShard {
+	std::shared_ptr<ArtNetEndpoint> endpoint;
+	// First socket on the same address, which runs discovery for it.
+	std::shared_ptr<ArtNetEndpoint> routes_endpoint;
+	ArtNetAddress destination;
+	int cpu = -1;
+	ArtNetShardWorker worker;
+
+	// This shard's part of the pass being sent, filled before the worker is posted.
+	std::vector<DmxUniverseBuffer *> list;
+	int frame = 0;
+	bool success = true;
+	bool send_failing = false; // failures are logged once per run
+
+	std::atomic<uint64_t> packets_sent{ 0 };
+	std::atomic<uint64_t> bytes_sent{ 0 };
+	std::atomic<uint64_t> send_errors{ 0 };
+	std::atomic<uint64_t> passes{ 0 };
+	std::atomic<uint64_t> send_time_total_ns{ 0 };
+	std::atomic<uint64_t> send_time_max_ns{ 0 };
+};
+
+struct ArtNetShardStats {
+	ArtNetAddress bind_address;
+	ArtNetAddress destination;
+	int cpu = -1;
+	bool pinned = false;
+	size_t universes = 0;
+	uint64_t packets_sent = 0;
+	uint64_t bytes_sent = 0;
+	uint64_t send_errors = 0;
+	double average_send_usec = 0.0; // per pass, including waiting for the socket
+	double max_send_usec = 0.0;
+};
+
+// Native Art-Net output: owns a set of universe buffers and builds ArtDmx
+// packets directly from them. The socket comes from the process-wide
+// ArtNetTransport and is shared with every other output on the same bind
+// address; the fixed-rate sender thread is shared by all outputs.
+class ArtNetOutput {
+	friend class ArtNetTransport;
+
+public:
+	static constexpr double MIN_REFRESH_RATE = 1.0;
+	static constexpr double MAX_REFRESH_RATE = 1000.0;
+
+	enum SendMode {
+		SEND_MODE_BROADCAST,
+		SEND_MODE_UNICAST, // to discovered subscribers, broadcast for unknown universes
+	};
+
+	// What the sender thread does with a scheduled frame it reaches more than
+	// the late tolerance after its target time.
+	enum LateFramePolicy {
+		LATE_FRAME_DROP,
+		LATE_FRAME_SEND_NOW,
+	};
+
+	static constexpr size_t DEFAULT_SCHEDULE_CAPACITY = 256;
+	static constexpr size_t MAX_SCHEDULE_CAPACITY = 65536;
+	static constexpr size_t FADE_QUEUE_CAPACITY = 256;
+	static constexpr size_t MAX_SHARDS = 16;
+
+private:
+	std::shared_ptr<ArtNetEndpoint> endpoint;
+	ArtNetAddress destination;
+	bool opened = false;
+	std::atomic<bool> enabled{ false };
+
+	DmxUniverseArena<DmxUniverseBuffer> universes;
+	std::vector<DmxUniverseBuffer *> universe_list; // sorted by Port-Address
+	std::vector<DmxUniverseBuffer *> batch; // scratch list reused by batch submits
+	std::vector<DmxUniverseBuffer *> sync_due; // scratch list for sends on the calling thread
+
+	// Delta transmission: skip universes whose contents match the last packet
+	// sent for them, but never for longer than the keep-alive interval.
+	std::atomic<bool> delta_enabled{ false };
+	std::atomic<uint64_t> packets_sent{ 0 };
+	std::atomic<uint64_t> packets_skipped{ 0 };
+
+	// ArtSync: after each pass that carries a new frame, an ArtSync tells
+	// nodes to latch every universe they have buffered at once.
+	std::atomic<bool> art_sync_enabled{ false };
+	std::atomic<uint64_t> syncs_sent{ 0 };
+
+	// Frame handoff to the sender thread. Each frame slot carries the universe
+	// set it was committed with, so universes created later never race the
+	// thread's iteration.
+	TripleBufferIndex frame_index;
+	std::vector<DmxUniverseBuffer *> frame_universes[3];
+
+	// Sender thread state. next_tick is only touched by the transport's
+	// sender thread while the output is registered with it.
+	bool sender_running = false;
+	std::chrono::steady_clock::duration refresh_period = std::chrono::microseconds(22727);
+	std::chrono::steady_clock::time_point next_tick;
+	std::vector<DmxUniverseBuffer *> due; // scratch list for the sender thread
+	std::atomic<int64_t> keep_alive_usec{ 1000000 };
+
+	std::atomic<int> send_mode{ SEND_MODE_BROADCAST };
+
+	// Timestamped frames played out by the sender thread. The game thread is
+	// the only producer; last_scheduled_usec keeps its pushes in time order.
+	DmxScheduleQueue schedule;
+	size_t schedule_capacity = DEFAULT_SCHEDULE_CAPACITY;
+	int64_t last_scheduled_usec = 0;
+	std::atomic<int> late_frame_policy{ LATE_FRAME_DROP };
+	std::atomic<int64_t> late_tolerance_usec{ 5000 };
+	std::vector<DmxUniverseBuffer *> scheduled_due; // scratch list for the sender thread
+	std::vector<DmxUniverseBuffer *> scheduled_keep_alive; // scratch list for the sender thread
+	std::atomic<uint64_t> scheduled_sent{ 0 };
+	std::atomic<uint64_t> scheduled_dropped{ 0 };
+	std::atomic<uint64_t> scheduled_late{ 0 };
+	std::atomic<uint64_t> timing_error_total_usec{ 0 };
+	std::atomic<uint64_t> timing_error_max_usec{ 0 };
+
+	// Fades run by the sender thread on top of the committed frames.
+	DmxFadeEngine fades;
+	std::vector<DmxUniverseBuffer *> fade_due; // scratch list for the sender thread
+
+	// Optional E1.31 output fed from the same universes; artnet_enabled lets
+	// it run on its own.
+	SacnOutput sacn;
+	std::atomic<bool> sacn_running{ false };
+	std::atomic<bool> artnet_enabled{ true };
+	bool realtime_priority = false;
+	bool discovery_running = false;
+
+	// Send shards, always at least one. The extra shards' addresses are kept
+	// so configure() can rebuild them for a new port.
+	std::vector<std::unique_ptr<ArtNetSendShard>> shards;
+	std::vector<ArtNetAddress> shard_bind_addresses;
+	std::vector<ArtNetAddress> shard_destinations; // port 0 when the output's broadcast address is used
+	std::vector<int> shard_cpus;
+
+	// Owner's layer stack, merged over the universes it covers while they are sent.
+	DmxLayerStack *layers = nullptr;
+	// Optional recording of every frame sent or committed from this output.
+	DmxRecordingWriter *recorder = nullptr;
+	bool record_received = false;
+
+	void commit_universes(DmxUniverseBuffer *const *list, size_t count);
+	bool send_slabs(DmxUniverseBuffer *const *list, size_t count);
+	bool should_send(DmxUniverseBuffer &universe, int frame, bool requested, std::chrono::steady_clock::time_point now);
+	// latch marks a pass that carries a new frame rather than keep-alives only.
+	bool emit(DmxUniverseBuffer *const *list, size_t count, int frame, bool latch);
+	bool emit_artnet(DmxUniverseBuffer *const *list, size_t count, int frame, bool latch);
+	bool send_shard(ArtNetSendShard &shard, DmxUniverseBuffer *const *list, size_t count, int frame);
+	void build_shards();
+
+	// Takes the output off the sender thread while protocol state changes.
+	bool pause_sender();
+	void resume_sender(bool paused);
+
+	bool schedule_universes(DmxUniverseBuffer *const *list, size_t count, const uint8_t *data, size_t stride, size_t size, int64_t target_usec);
+	DmxUniverseBuffer *get_fade_universe(uint16_t port_address, uint16_t channel, size_t count);
+	// Merges held channels into FADE_FRAME and collects the universes to send.
+	bool collect_fades(uint8_t front, std::chrono::steady_clock::time_point now);
+	void send_periodic(std::chrono::steady_clock::time_point now);
+	void play_schedule();
+
+	// Called by the transport's sender thread. tick() runs the periodic pass
+	// when next_tick is due and plays out scheduled frames that are due.
+	std::chrono::steady_clock::time_point get_next_tick() const { return next_tick; }
+	std::chrono::steady_clock::time_point get_next_scheduled() const;
+	void tick(std::chrono::steady_clock::time_point now);
+
+public:
+	ArtNetOutput();
+	~ArtNetOutput();
+
+	// destination_port defaults to port; only tools running sender and receiver
+	// on one host need them to differ.
+	bool configure(const std::string &bind_address, uint16_t port, const std::string &broadcast_address, uint16_t destination_port = 0);
+
+	bool open();
+	void close();
+	bool is_open() const { return opened; }
+	const std::shared_ptr<ArtNetEndpoint> &get_endpoint() const { return endpoint; }
+
+	void set_enabled(bool enable) { enabled = enable; }
+	bool is_enabled() const { return enabled; }
+
+	// Spreads Art-Net sending over more sockets: universe u goes out of shard
+	// u % get_shard_count(). Shard 0 is the configure() address; the listed
+	// addresses add shards 1 and up, each sent by a worker thread pinned to
+	// the matching cpu (negative to leave it unpinned). An address may repeat
+	// to open several sockets on one interface. Empty broadcast addresses use
+	// the output's. Only while the output is closed; empty lists go back to
+	// one shard.
+	bool configure_shards(const std::vector<std::string> &bind_addresses, const std::vector<std::string> &broadcast_addresses, const std::vector<int> &cpus);
+	size_t get_shard_count() const { return shards.size(); }
+	size_t get_universe_shard(uint16_t port_address) const { return port_address % shards.size(); }
+	ArtNetShardStats get_shard_stats(size_t shard) const;
+
+	// Returns the buffer for a Port-Address, creating it on first use. Returns
+	// nullptr if another output on the same bind address already owns it.
+	DmxUniverseBuffer *get_universe(uint16_t port_address);
+	DmxUniverseBuffer *find_universe(uint16_t port_address) const;
+
+	// Copies data into the universe slab and clears any channels past it.
+	bool set_universe_data(uint16_t port_address, const uint8_t *data, size_t size);
+
+	// For writers that fill many universes in one pass: resolves each
+	// Port-Address to its buffer and slab, then, after the pass, grows each
+	// buffer's length to cover ends[i], the end of what was written to it.
+	bool bind_universes(const std::vector<uint16_t> &universes, std::vector<DmxUniverseBuffer *> &r_buffers, std::vector<uint8_t *> &r_slabs);
+	static void extend_lengths(const std::vector<DmxUniverseBuffer *> &buffers, const std::vector<uint16_t> &ends);
+
+	// Batch submit: data holds DMX_UNIVERSE_SIZE bytes per universe, either for
+	// consecutive Port-Addresses from first_universe or for the listed ones.
+	// All universes are updated first and then sent in one pass.
+	bool send_universe_range(uint16_t first_universe, const uint8_t *data, size_t size);
+	bool send_universe_list(const int32_t *port_addresses, size_t count, const uint8_t *data, size_t size);
+
+	// Sends immediately on the calling thread, or commits the universes for
+	// the sender thread when it is running.
+	bool send_universe(DmxUniverseBuffer &universe);
+	bool send_universes(DmxUniverseBuffer *const *list, size_t count);
+	bool send_all();
+
+	// Registers with the shared fixed-rate sender thread. Committed universes go
+	// out on the next tick; unchanged universes are resent every keep-alive interval.
+	bool start_sender(double rate_hz, bool realtime_priority);
+	void stop_sender();
+	bool is_sender_running();
+
+	void set_keep_alive_interval(double seconds);
+	double get_keep_alive_interval() const;
+
+	// Scheduled playout: frames are queued with a target time on the steady
+	// clock (see get_clock_usec()) and sent by the sender thread at that time,
+	// so they only play while it runs. Targets must not go backwards. Once a
+	// universe has a frame scheduled, commits no longer send it until
+	// clear_schedule() or stop_sender().
+	static int64_t get_clock_usec();
+	bool schedule_universe(uint16_t port_address, const uint8_t *data, size_t size, int64_t target_usec);
+	// data holds DMX_UNIVERSE_SIZE bytes per universe from first_universe; all
+	// universes are queued with the same target, or none if they do not fit.
+	bool schedule_universe_range(uint16_t first_universe, const uint8_t *data, size_t size, int64_t target_usec);
+	void clear_schedule();
+	size_t get_scheduled_count() const { return schedule.size(); }
+	// Only while the sender thread is stopped.
+	bool set_schedule_capacity(size_t frames);
+	size_t get_schedule_capacity() const { return schedule_capacity; }
+	void set_late_frame_policy(LateFramePolicy policy) { late_frame_policy = policy; }
+	LateFramePolicy get_late_frame_policy() const { return static_cast<LateFramePolicy>(late_frame_policy.load()); }
+	void set_late_frame_tolerance(double seconds);
+	double get_late_frame_tolerance() const;
+
+	// Playout timing, measured when each frame is handed to the socket.
+	uint64_t get_scheduled_frames_sent() const { return scheduled_sent.load(std::memory_order_relaxed); }
+	uint64_t get_scheduled_frames_dropped() const { return scheduled_dropped.load(std::memory_order_relaxed); }
+	uint64_t get_scheduled_frames_late() const { return scheduled_late.load(std::memory_order_relaxed); }
+	double get_average_timing_error_usec() const;
+	double get_max_timing_error_usec() const { return static_cast<double>(timing_error_max_usec.load(std::memory_order_relaxed)); }
+
+	// Fades: the sender thread moves channels from their current level to the
+	// targets over duration_seconds and then holds them there, overriding what
+	// the game commits, until they are released. Only while the sender thread
+	// runs; stop_sender() releases everything. Universes driven by the
+	// schedule are not faded.
+	bool fade_channels(uint16_t port_address, uint16_t channel, const uint8_t *targets, size_t count, double duration_seconds, DmxFadeCurve curve);
+	bool fade_channel_range(uint16_t port_address, uint16_t channel, size_t count, uint8_t target, double duration_seconds, DmxFadeCurve curve);
+	bool release_fades(uint16_t port_address, uint16_t channel, size_t count);
+	bool release_all_fades();
+	size_t get_running_fade_count() const { return fades.get_running_fade_count(); }
+
+	// Nodes that stop receiving ArtSync fall back to latching each universe
+	// on arrival after ART_SYNC_TIMEOUT, as Art-Net 4 requires, so turning
+	// this off (or pausing output) needs no handshake.
+	static constexpr std::chrono::seconds ART_SYNC_TIMEOUT{ 4 };
+	void set_art_sync_enabled(bool enable) { art_sync_enabled = enable; }
+	bool is_art_sync_enabled() const { return art_sync_enabled; }
+	uint64_t get_syncs_sent() const { return syncs_sent.load(std::memory_order_relaxed); }
+
+	void set_delta_enabled(bool enable) { delta_enabled = enable; }
+	bool is_delta_enabled() const { return delta_enabled; }
+
+	// ArtPoll discovery and unicast routing.
+	bool start_discovery(double poll_interval_seconds);
+	void stop_discovery();
+	bool is_discovery_running() const { return discovery_running; }
+	std::shared_ptr<const ArtNetRoutingTable> get_routing_table(size_t shard = 0) const;
+	// One node table per distinct shard address, in shard order.
+	std::vector<std::shared_ptr<const ArtNetNodeTable>> get_node_tables() const;
+
+	void set_send_mode(SendMode mode) { send_mode = mode; }
+	SendMode get_send_mode() const { return static_cast<SendMode>(send_mode.load()); }
+
+	// E1.31 output from the same universe buffers. configure_sacn() is only
+	// allowed while sACN is stopped; the output must be open to start it.
+	bool configure_sacn(const std::string &bind_address, const std::string &source_name, int universe_offset, uint16_t destination_port = SACN_DEFAULT_PORT);
+	bool start_sacn();
+	void stop_sacn();
+	bool is_sacn_running() const { return sacn_running; }
+	SacnOutput &get_sacn() { return sacn; }
+	const SacnOutput &get_sacn() const { return sacn; }
+
+	// Layers merged over their universes for the duration of every send_universes() call.
+	void set_layer_stack(DmxLayerStack *p_layers) { layers = p_layers; }
+
+	// Records every frame passed to send_universes() until cleared with
+	// nullptr. record_received asks the owner to add received universes too.
+	void set_recorder(DmxRecordingWriter *writer, bool p_record_received) {
+		recorder = writer;
+		record_received = writer && p_record_received;
+	}
+	DmxRecordingWriter *get_recorder() const { return recorder; }
+	bool is_recording_received() const { return record_received; }
+
+	void set_artnet_enabled(bool enable) { artnet_enabled = enable; }
+	bool is_artnet_enabled() const { return artnet_enabled; }
+
+	// Seconds since the universe was last sent, or a negative value if it never was.
+	double get_send_age(uint16_t port_address) const;
+	// Largest send age over every universe that has been sent at least once.
+	double get_oldest_send_age() const;
+
+	uint64_t get_packets_sent() const { return packets_sent.load(std::memory_order_relaxed); }
+	uint64_t get_packets_skipped() const { return packets_skipped.load(std::memory_order_relaxed); }
+	void reset_counters();
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+// Art-Net 4 wire format constants and helpers shared by the native send path.
+// Everything in here is plain C++ so it can be used outside of Godot types.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+static constexpr uint16_t ARTNET_DEFAULT_PORT = 6454;
+static constexpr uint16_t ARTNET_PROTOCOL_VERSION = 14;
+static constexpr uint16_t ARTNET_MAX_PORT_ADDRESS = 0x7FFF;
+
+static constexpr uint16_t ARTNET_OP_POLL = 0x2000;
+static constexpr uint16_t ARTNET_OP_POLL_REPLY = 0x2100;
+static constexpr uint16_t ARTNET_OP_DMX = 0x5000;
+static constexpr uint16_t ARTNET_OP_SYNC = 0x5200;
+
+static constexpr size_t ARTNET_HEADER_SIZE = 10; // ID + OpCode
+static constexpr size_t ARTNET_DMX_HEADER_SIZE = 18;
+static constexpr size_t ARTNET_POLL_SIZE = 14;
+static constexpr size_t ARTNET_SYNC_SIZE = 14;
+static constexpr size_t ARTNET_POLL_REPLY_MIN_SIZE = 207; // through MAC; BindIp and later are optional
+static constexpr size_t DMX_UNIVERSE_SIZE = 512;
+
+// ArtPoll flag: ask nodes to send ArtPollReply on their own whenever their configuration changes.
+static constexpr uint8_t ARTNET_POLL_FLAG_REPLY_ON_CHANGE = 0x02;
+
+// ArtPollReply field offsets.
+static constexpr size_t ARTNET_POLL_REPLY_IP = 10;
+static constexpr size_t ARTNET_POLL_REPLY_VERSION_INFO = 16; // big-endian
+static constexpr size_t ARTNET_POLL_REPLY_NET_SWITCH = 18;
+static constexpr size_t ARTNET_POLL_REPLY_SUB_SWITCH = 19;
+static constexpr size_t ARTNET_POLL_REPLY_OEM = 20; // big-endian
+static constexpr size_t ARTNET_POLL_REPLY_STATUS1 = 23;
+static constexpr size_t ARTNET_POLL_REPLY_ESTA_MAN = 24; // little-endian
+static constexpr size_t ARTNET_POLL_REPLY_SHORT_NAME = 26;
+static constexpr size_t ARTNET_POLL_REPLY_LONG_NAME = 44;
+static constexpr size_t ARTNET_POLL_REPLY_NUM_PORTS = 173; // low byte
+static constexpr size_t ARTNET_POLL_REPLY_PORT_TYPES = 174;
+static constexpr size_t ARTNET_POLL_REPLY_GOOD_INPUT = 178;
+static constexpr size_t ARTNET_POLL_REPLY_GOOD_OUTPUT = 182;
+static constexpr size_t ARTNET_POLL_REPLY_SW_IN = 186;
+static constexpr size_t ARTNET_POLL_REPLY_SW_OUT = 190;
+static constexpr size_t ARTNET_POLL_REPLY_MAC = 201;
+static constexpr size_t ARTNET_POLL_REPLY_BIND_INDEX = 211;
+static constexpr size_t ARTNET_POLL_REPLY_STATUS2 = 212;
+static constexpr size_t ARTNET_SHORT_NAME_SIZE = 18;
+static constexpr size_t ARTNET_LONG_NAME_SIZE = 64;
+static constexpr uint8_t ARTNET_PORT_TYPE_OUTPUT = 0x80;
+static constexpr uint8_t ARTNET_PORT_TYPE_INPUT = 0x40;
+
+static constexpr uint8_t ARTNET_ID[8] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+
+// Builds a 15-bit Port-Address from its Net (0-127), Sub-Net (0-15) and Universe (0-15) parts.
+inline uint16_t artnet_port_address(uint8_t net, uint8_t subnet, uint8_t universe) {
+	return static_cast<uint16_t>(((net & 0x7F) << 8) | ((subnet & 0x0F) << 4) | (universe & 0x0F));
+}
+
+// Art-Net requires an even DMX payload length between 2 and 512 slots.
+inline uint16_t artnet_dmx_length(size_t slots) {
+	if (slots < 2) {
+		return 2;
+	}
+	if (slots >= DMX_UNIVERSE_SIZE) {
+		return static_cast<uint16_t>(DMX_UNIVERSE_SIZE);
+	}
+	return static_cast<uint16_t>((slots + 1) & ~static_cast<size_t>(1));
+}
+
+// Sequence numbers run 1..255; 0 tells receivers that sequencing is disabled.
+inline uint8_t artnet_next_sequence(uint8_t sequence) {
+	return sequence == 255 ? 1 : static_cast<uint8_t>(sequence + 1);
+}
+
+// Writes the 18-byte ArtDmx header into dst.
+inline void artnet_write_dmx_header(uint8_t *dst, uint8_t sequence, uint16_t port_address, uint16_t length) {
+	std::memcpy(dst, ARTNET_ID, sizeof(ARTNET_ID));
+	dst[8] = ARTNET_OP_DMX & 0xFF; // OpCode is little-endian
+	dst[9] = ARTNET_OP_DMX >> 8;
+	dst[10] = ARTNET_PROTOCOL_VERSION >> 8;
+	dst[11] = ARTNET_PROTOCOL_VERSION & 0xFF;
+	dst[12] = sequence;
+	dst[13] = 0; // Physical
+	dst[14] = port_address & 0xFF; // SubUni
+	dst[15] = (port_address >> 8) & 0x7F; // Net
+	dst[16] = length >> 8;
+	dst[17] = length & 0xFF;
+}
+
+// Updates the per-packet fields of a header written by artnet_write_dmx_header().
+inline void artnet_patch_dmx_header(uint8_t *header, uint8_t sequence, uint16_t length) {
+	header[12] = sequence;
+	header[16] = length >> 8;
+	header[17] = length & 0xFF;
+}
+
+// Writes a 14-byte ArtSync packet into dst.
+inline void artnet_write_sync(uint8_t *dst) {
+	std::memcpy(dst, ARTNET_ID, sizeof(ARTNET_ID));
+	dst[8] = ARTNET_OP_SYNC & 0xFF;
+	dst[9] = ARTNET_OP_SYNC >> 8;
+	dst[10] = ARTNET_PROTOCOL_VERSION >> 8;
+	dst[11] = ARTNET_PROTOCOL_VERSION & 0xFF;
+	dst[12] = 0; // Aux1
+	dst[13] = 0; // Aux2
+}
+
+// Returns the OpCode of an Art-Net packet, or 0 if data is not one.
+inline uint16_t artnet_read_opcode(const uint8_t *data, size_t size) {
+	if (size < ARTNET_HEADER_SIZE || std::memcmp(data, ARTNET_ID, sizeof(ARTNET_ID)) != 0) {
+		return 0;
+	}
+	return static_cast<uint16_t>(data[8] | (data[9] << 8));
+}
+
+// Fields of a received ArtDmx packet. data points into the packet.
+struct ArtNetDmxPacket {
+	uint16_t port_address = 0;
+	uint8_t sequence = 0; // 0 when the sender does not sequence its packets
+	uint8_t physical = 0;
+	uint16_t length = 0; // clamped to the payload actually present and to 512
+	const uint8_t *data = nullptr;
+};
+
+// Parses an ArtDmx packet. Returns false if it is not one.
+inline bool artnet_parse_dmx(const uint8_t *packet, size_t size, ArtNetDmxPacket &r_packet) {
+	if (size < ARTNET_DMX_HEADER_SIZE + 2 || artnet_read_opcode(packet, size) != ARTNET_OP_DMX) {
+		return false;
+	}
+	size_t length = static_cast<size_t>((packet[16] << 8) | packet[17]);
+	r_packet.port_address = static_cast<uint16_t>(packet[14] | ((packet[15] & 0x7F) << 8));
+	r_packet.sequence = packet[12];
+	r_packet.physical = packet[13];
+	r_packet.length = static_cast<uint16_t>(std::min({ length, size - ARTNET_DMX_HEADER_SIZE, DMX_UNIVERSE_SIZE }));
+	r_packet.data = packet + ARTNET_DMX_HEADER_SIZE;
+	return true;
+}
+
+// Writes a 14-byte ArtPoll packet into dst.
+inline void artnet_write_poll(uint8_t *dst, uint8_t flags) {
+	std::memcpy(dst, ARTNET_ID, sizeof(ARTNET_ID));
+	dst[8] = ARTNET_OP_POLL & 0xFF;
+	dst[9] = ARTNET_OP_POLL >> 8;
+	dst[10] = ARTNET_PROTOCOL_VERSION >> 8;
+	dst[11] = ARTNET_PROTOCOL_VERSION & 0xFF;
+	dst[12] = flags;
+	dst[13] = 0; // DiagPriority
+}
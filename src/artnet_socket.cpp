@@ -0,0 +1,286 @@
+#include "artnet_socket.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+bool ensure_winsock() {
+	static const bool initialized = [] {
+		WSADATA data;
+		return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}();
+	return initialized;
+}
+#endif
+
+int last_socket_error() {
+#ifdef _WIN32
+	return WSAGetLastError();
+#else
+	return errno;
+#endif
+}
+
+sockaddr_in to_sockaddr(const ArtNetAddress &address) {
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = address.ip;
+	addr.sin_port = htons(address.port);
+	return addr;
+}
+
+} // namespace
+
+bool ArtNetAddress::parse(const std::string &address, uint16_t port, ArtNetAddress &r_address) {
+#ifdef _WIN32
+	if (!ensure_winsock()) {
+		return false;
+	}
+#endif
+	in_addr parsed = {};
+	if (inet_pton(AF_INET, address.c_str(), &parsed) != 1) {
+		return false;
+	}
+	r_address.ip = parsed.s_addr;
+	r_address.port = port;
+	return true;
+}
+
+ArtNetSocket::~ArtNetSocket() {
+	close();
+}
+
+bool ArtNetSocket::open(const ArtNetAddress &bind_address) {
+	close();
+
+#ifdef _WIN32
+	if (!ensure_winsock()) {
+		return false;
+	}
+	SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock == INVALID_SOCKET) {
+		return false;
+	}
+	const char enable = 1;
+#else
+	int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sock < 0) {
+		return false;
+	}
+	const int enable = 1;
+#endif
+	handle = static_cast<intptr_t>(sock);
+
+	// Art-Net shares port 6454 with every other controller and node on the host.
+	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+#if defined(SO_REUSEPORT) && !defined(__linux__)
+	// BSD and macOS only let several sockets share a unicast address and port
+	// with SO_REUSEPORT. Linux allows it for UDP with SO_REUSEADDR alone, where
+	// SO_REUSEPORT would also spread incoming packets over the sockets.
+	setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+#endif
+	if (setsockopt(sock, SOL_SOCKET, SO_BROADCAST, &enable, sizeof(enable)) != 0) {
+		close();
+		return false;
+	}
+
+	sockaddr_in addr = to_sockaddr(bind_address);
+	if (bind(sock, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void ArtNetSocket::close() {
+	if (handle == -1) {
+		return;
+	}
+#ifdef _WIN32
+	closesocket(static_cast<SOCKET>(handle));
+#else
+	::close(static_cast<int>(handle));
+#endif
+	handle = -1;
+}
+
+bool ArtNetSocket::set_multicast_interface(const ArtNetAddress &interface_address) {
+	if (handle == -1) {
+		return false;
+	}
+	in_addr address = {};
+	address.s_addr = interface_address.ip;
+#ifdef _WIN32
+	return setsockopt(static_cast<SOCKET>(handle), IPPROTO_IP, IP_MULTICAST_IF, reinterpret_cast<const char *>(&address), sizeof(address)) == 0;
+#else
+	return setsockopt(static_cast<int>(handle), IPPROTO_IP, IP_MULTICAST_IF, &address, sizeof(address)) == 0;
+#endif
+}
+
+bool ArtNetSocket::send_to(const ArtNetAddress &destination, const uint8_t *data, size_t size) {
+	if (handle == -1) {
+		return false;
+	}
+	sockaddr_in addr = to_sockaddr(destination);
+#ifdef _WIN32
+	int sent = sendto(static_cast<SOCKET>(handle), reinterpret_cast<const char *>(data), static_cast<int>(size), 0, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr));
+	return sent == static_cast<int>(size);
+#else
+	ssize_t sent = sendto(static_cast<int>(handle), data, size, 0, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr));
+	return sent == static_cast<ssize_t>(size);
+#endif
+}
+
+int ArtNetSocket::receive(uint8_t *buffer, size_t size, ArtNetAddress &r_from, int timeout_ms) {
+	if (handle == -1) {
+		return -1;
+	}
+	sockaddr_in addr = {};
+#ifdef _WIN32
+	WSAPOLLFD descriptor = {};
+	descriptor.fd = static_cast<SOCKET>(handle);
+	descriptor.events = POLLRDNORM;
+	if (WSAPoll(&descriptor, 1, timeout_ms) <= 0) {
+		return -1;
+	}
+	int addr_size = sizeof(addr);
+	int received = recvfrom(static_cast<SOCKET>(handle), reinterpret_cast<char *>(buffer), static_cast<int>(size), 0, reinterpret_cast<sockaddr *>(&addr), &addr_size);
+#else
+	pollfd descriptor = {};
+	descriptor.fd = static_cast<int>(handle);
+	descriptor.events = POLLIN;
+	if (poll(&descriptor, 1, timeout_ms) <= 0) {
+		return -1;
+	}
+	socklen_t addr_size = sizeof(addr);
+	ssize_t received = recvfrom(static_cast<int>(handle), buffer, size, 0, reinterpret_cast<sockaddr *>(&addr), &addr_size);
+#endif
+	if (received < 0) {
+		return -1;
+	}
+	r_from.ip = addr.sin_addr.s_addr;
+	r_from.port = ntohs(addr.sin_port);
+	return static_cast<int>(received);
+}
+
+bool ArtNetSocket::send_gather(const ArtNetAddress &destination, const uint8_t *header, size_t header_size, const uint8_t *payload, size_t payload_size) {
+	if (handle == -1) {
+		return false;
+	}
+	sockaddr_in addr = to_sockaddr(destination);
+
+#ifdef _WIN32
+	WSABUF buffers[2];
+	buffers[0].buf = reinterpret_cast<CHAR *>(const_cast<uint8_t *>(header));
+	buffers[0].len = static_cast<ULONG>(header_size);
+	buffers[1].buf = reinterpret_cast<CHAR *>(const_cast<uint8_t *>(payload));
+	buffers[1].len = static_cast<ULONG>(payload_size);
+	DWORD sent = 0;
+	int result = WSASendTo(static_cast<SOCKET>(handle), buffers, 2, &sent, 0, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr), nullptr, nullptr);
+	return result == 0 && sent == header_size + payload_size;
+#else
+	iovec buffers[2];
+	buffers[0].iov_base = const_cast<uint8_t *>(header);
+	buffers[0].iov_len = header_size;
+	buffers[1].iov_base = const_cast<uint8_t *>(payload);
+	buffers[1].iov_len = payload_size;
+
+	msghdr message = {};
+	message.msg_name = &addr;
+	message.msg_namelen = sizeof(addr);
+	message.msg_iov = buffers;
+	message.msg_iovlen = 2;
+	ssize_t sent = sendmsg(static_cast<int>(handle), &message, 0);
+	return sent == static_cast<ssize_t>(header_size + payload_size);
+#endif
+}
+
+size_t ArtNetSocket::send_batch(const ArtNetDatagram *datagrams, size_t count, int *r_error, bool *r_sent) {
+	if (r_error) {
+		*r_error = 0;
+	}
+	if (count > MAX_BATCH) {
+		count = MAX_BATCH;
+	}
+	if (r_sent) {
+		std::fill(r_sent, r_sent + count, false);
+	}
+	if (handle == -1 || count == 0) {
+		return 0;
+	}
+
+#if defined(__linux__)
+	sockaddr_in addresses[MAX_BATCH];
+	iovec buffers[MAX_BATCH * 2];
+	mmsghdr messages[MAX_BATCH];
+	for (size_t i = 0; i < count; i++) {
+		const ArtNetDatagram &datagram = datagrams[i];
+		addresses[i] = to_sockaddr(*datagram.destination);
+		buffers[i * 2].iov_base = const_cast<uint8_t *>(datagram.header);
+		buffers[i * 2].iov_len = datagram.header_size;
+		buffers[i * 2 + 1].iov_base = const_cast<uint8_t *>(datagram.payload);
+		buffers[i * 2 + 1].iov_len = datagram.payload_size;
+
+		messages[i] = {};
+		messages[i].msg_hdr.msg_name = &addresses[i];
+		messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+		messages[i].msg_hdr.msg_iov = &buffers[i * 2];
+		messages[i].msg_hdr.msg_iovlen = 2;
+	}
+
+	// sendmmsg() stops at the first message that fails. Skip only that one,
+	// so one unreachable destination does not drop the rest of the batch.
+	size_t sent = 0;
+	size_t next = 0;
+	while (next < count) {
+		int result = sendmmsg(static_cast<int>(handle), messages + next, static_cast<unsigned int>(count - next), 0);
+		if (result <= 0) {
+			if (r_error && *r_error == 0) {
+				*r_error = last_socket_error();
+			}
+			next++;
+			continue;
+		}
+		if (r_sent) {
+			std::fill(r_sent + next, r_sent + next + result, true);
+		}
+		next += static_cast<size_t>(result);
+		sent += static_cast<size_t>(result);
+	}
+	return sent;
+#else
+	size_t sent = 0;
+	for (size_t i = 0; i < count; i++) {
+		const ArtNetDatagram &datagram = datagrams[i];
+		if (send_gather(*datagram.destination, datagram.header, datagram.header_size, datagram.payload, datagram.payload_size)) {
+			sent++;
+			if (r_sent) {
+				r_sent[i] = true;
+			}
+		} else if (r_error && *r_error == 0) {
+			*r_error = last_socket_error();
+		}
+	}
+	return sent;
+#endif
+}
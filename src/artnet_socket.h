@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// IPv4 endpoint kept free of platform socket headers.
+// ip is stored in network byte order, port in host byte order.
+struct ArtNetAddress {
+	uint32_t ip = 0;
+	uint16_t port = 0;
+
+	static bool parse(const std::string &address, uint16_t port, ArtNetAddress &r_address);
+};
+
+// One outgoing datagram made of a header and a payload kept in separate buffers.
+struct ArtNetDatagram {
+	const ArtNetAddress *destination = nullptr;
+	const uint8_t *header = nullptr;
+	size_t header_size = 0;
+	const uint8_t *payload = nullptr;
+	size_t payload_size = 0;
+};
+
+// Thin UDP socket used by the native Art-Net send path.
+class ArtNetSocket {
+	intptr_t handle = -1;
+
+public:
+	ArtNetSocket() = default;
+	~ArtNetSocket();
+
+	ArtNetSocket(const ArtNetSocket &) = delete;
+	ArtNetSocket &operator=(const ArtNetSocket &) = delete;
+
+	bool open(const ArtNetAddress &bind_address);
+	void close();
+	bool is_open() const { return handle != -1; }
+
+	// Sends multicast traffic out of the interface with this address.
+	bool set_multicast_interface(const ArtNetAddress &interface_address);
+
+	bool send_to(const ArtNetAddress &destination, const uint8_t *data, size_t size);
+
+	// Waits up to timeout_ms for a datagram. Returns its size, or -1 on timeout or error.
+	int receive(uint8_t *buffer, size_t size, ArtNetAddress &r_from, int timeout_ms);
+
+	// Sends header and payload as a single datagram without joining them in memory first.
+	bool send_gather(const ArtNetAddress &destination, const uint8_t *header, size_t header_size, const uint8_t *payload, size_t payload_size);
+
+	// Sends up to MAX_BATCH datagrams, using a single sendmmsg() call where the
+	// platform has it. A datagram that fails is skipped and the rest are still
+	// sent. Returns how many datagrams were sent; if that is fewer than count,
+	// r_error receives the first socket error code (errno or WSAGetLastError())
+	// and r_sent, if given, tells which datagrams went out.
+	static constexpr size_t MAX_BATCH = 64;
+	size_t send_batch(const ArtNetDatagram *datagrams, size_t count, int *r_error = nullptr, bool *r_sent = nullptr);
+};
@@ -0,0 +1,92 @@
+#include "artnet_stats.h"
+
+ArtNetStats &ArtNetStats::get_singleton() {
+	static ArtNetStats stats;
+	return stats;
+}
+
+void ArtNetStats::record_send(size_t attempted, size_t sent, size_t bytes, uint64_t latency_ns, int error) {
+	packets_sent.fetch_add(sent, std::memory_order_relaxed);
+	bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+	send_calls.fetch_add(1, std::memory_order_relaxed);
+	send_latency_total_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+
+	uint64_t max = send_latency_max_ns.load(std::memory_order_relaxed);
+	while (latency_ns > max && !send_latency_max_ns.compare_exchange_weak(max, latency_ns, std::memory_order_relaxed)) {
+	}
+
+	if (sent < attempted) {
+		// Counted per packet, so a failed batch weighs as much as the packets it lost.
+		packets_dropped.fetch_add(attempted - sent, std::memory_order_relaxed);
+		record_error(error, attempted - sent);
+	}
+}
+
+void ArtNetStats::record_error(int code, uint64_t packets) {
+	if (code == 0) {
+		code = -1;
+	}
+	for (ErrorSlot &slot : errors) {
+		int current = slot.code.load(std::memory_order_relaxed);
+		if (current == 0 && slot.code.compare_exchange_strong(current, code, std::memory_order_relaxed)) {
+			current = code;
+		}
+		if (current == code) {
+			slot.count.fetch_add(packets, std::memory_order_relaxed);
+			return;
+		}
+	}
+	other_errors.fetch_add(packets, std::memory_order_relaxed);
+}
+
+uint64_t ArtNetStats::get_send_errors() const {
+	uint64_t total = other_errors.load(std::memory_order_relaxed);
+	for (const ErrorSlot &slot : errors) {
+		total += slot.count.load(std::memory_order_relaxed);
+	}
+	return total;
+}
+
+double ArtNetStats::get_average_send_latency_ns() const {
+	uint64_t calls = send_calls.load(std::memory_order_relaxed);
+	if (calls == 0) {
+		return 0.0;
+	}
+	return static_cast<double>(send_latency_total_ns.load(std::memory_order_relaxed)) / static_cast<double>(calls);
+}
+
+std::vector<std::pair<int, uint64_t>> ArtNetStats::get_send_error_counts() const {
+	std::vector<std::pair<int, uint64_t>> counts;
+	uint64_t other = other_errors.load(std::memory_order_relaxed);
+	for (const ErrorSlot &slot : errors) {
+		int code = slot.code.load(std::memory_order_relaxed);
+		uint64_t count = slot.count.load(std::memory_order_relaxed);
+		if (code == 0 || count == 0) {
+			continue;
+		}
+		if (code == -1) {
+			other += count;
+		} else {
+			counts.emplace_back(code, count);
+		}
+	}
+	if (other > 0) {
+		counts.emplace_back(-1, other);
+	}
+	return counts;
+}
+
+void ArtNetStats::reset() {
+	packets_sent = 0;
+	packets_dropped = 0;
+	bytes_sent = 0;
+	send_calls = 0;
+	send_latency_total_ns = 0;
+	send_latency_max_ns = 0;
+	sender_overruns = 0;
+	// Codes stay claimed so slots are not reshuffled under a concurrent sender.
+	for (ErrorSlot &slot : errors) {
+		slot.count = 0;
+	}
+	other_errors = 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Process-wide send path counters. Every field is a relaxed atomic written by
+// whichever thread sends, so updating them costs a few uncontended atomic adds
+// per batch and reading them never blocks the sender.
+class ArtNetStats {
+public:
+	// Distinct error codes tracked individually; anything beyond lands in other_errors.
+	static constexpr size_t ERROR_SLOTS = 8;
+
+private:
+	struct ErrorSlot {
+		std::atomic<int> code{ 0 }; // 0 marks a free slot
+		std::atomic<uint64_t> count{ 0 };
+	};
+
+	std::atomic<uint64_t> packets_sent{ 0 };
+	std::atomic<uint64_t> packets_dropped{ 0 };
+	std::atomic<uint64_t> bytes_sent{ 0 };
+	std::atomic<uint64_t> send_calls{ 0 };
+	std::atomic<uint64_t> send_latency_total_ns{ 0 };
+	std::atomic<uint64_t> send_latency_max_ns{ 0 };
+	std::atomic<uint64_t> sender_overruns{ 0 };
+
+	ErrorSlot errors[ERROR_SLOTS];
+	std::atomic<uint64_t> other_errors{ 0 };
+
+	void record_error(int code, uint64_t packets);
+
+public:
+	static ArtNetStats &get_singleton();
+
+	// One send call that tried to send attempted datagrams. error is the
+	// socket error code when fewer than attempted went out, 0 otherwise.
+	void record_send(size_t attempted, size_t sent, size_t bytes, uint64_t latency_ns, int error);
+
+	// The sender thread fell more than a whole period behind and skipped ticks.
+	void record_overrun() { sender_overruns.fetch_add(1, std::memory_order_relaxed); }
+
+	uint64_t get_packets_sent() const { return packets_sent.load(std::memory_order_relaxed); }
+	uint64_t get_packets_dropped() const { return packets_dropped.load(std::memory_order_relaxed); }
+	uint64_t get_bytes_sent() const { return bytes_sent.load(std::memory_order_relaxed); }
+	uint64_t get_sender_overruns() const { return sender_overruns.load(std::memory_order_relaxed); }
+	// Packets that failed to send, like get_packets_dropped(), but grouped by error code.
+	uint64_t get_send_errors() const;
+
+	// Average and maximum duration of one send call (a whole sendmmsg() batch
+	// where the platform has it), in nanoseconds.
+	double get_average_send_latency_ns() const;
+	uint64_t get_max_send_latency_ns() const { return send_latency_max_ns.load(std::memory_order_relaxed); }
+
+	// (error code, packets) pairs with a non-zero count. Code -1 collects errors
+	// that did not fit in the fixed slots.
+	std::vector<std::pair<int, uint64_t>> get_send_error_counts() const;
+
+	void reset();
+};
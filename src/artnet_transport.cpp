@@ -0,0 +1,447 @@
+#include "artnet_transport.h"
+
+#include <algorithm>
+
+#include <pthread.h>
+#include <sched.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+#include "artnet_input.h"
+#include "artnet_log.h"
+#include "artnet_output.h"
+#include "artnet_protocol.h"
+
+// On Windows this goes through the compat pthread/sched shims, which map a
+// positive priority onto THREAD_PRIORITY_ABOVE_NORMAL.
+bool artnet_set_current_thread_realtime() {
+	int min_priority = sched_get_priority_min(SCHED_FIFO);
+	int max_priority = sched_get_priority_max(SCHED_FIFO);
+	sched_param param;
+	param.sched_priority = min_priority + (max_priority - min_priority) / 2;
+	if (param.sched_priority <= 0) {
+		param.sched_priority = max_priority;
+	}
+	return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+bool artnet_pin_current_thread(int cpu) {
+	if (cpu < 0) {
+		return false;
+	}
+#if defined(_WIN32)
+	if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+		return false;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#elif defined(__linux__)
+	if (cpu >= CPU_SETSIZE) {
+		return false;
+	}
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+void ArtNetShardWorker::start(int p_cpu, std::function<void()> p_task) {
+	stop();
+	cpu = p_cpu;
+	task = std::move(p_task);
+	stop_requested = false;
+	pending = false;
+	pinned = false;
+	thread = std::thread(&ArtNetShardWorker::loop, this);
+}
+
+void ArtNetShardWorker::stop() {
+	if (!thread.joinable()) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop_requested = true;
+	}
+	wake.notify_one();
+	thread.join();
+}
+
+void ArtNetShardWorker::post() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending = true;
+	}
+	wake.notify_one();
+}
+
+void ArtNetShardWorker::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return !pending; });
+}
+
+void ArtNetShardWorker::loop() {
+	if (cpu >= 0) {
+		pinned = artnet_pin_current_thread(cpu);
+	}
+	bool realtime_applied = false;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wake.wait(lock, [this] { return stop_requested || pending; });
+		if (stop_requested) {
+			break;
+		}
+		lock.unlock();
+		if (!realtime_applied && realtime_requested.load(std::memory_order_relaxed)) {
+			artnet_set_current_thread_realtime();
+			realtime_applied = true;
+		}
+		task();
+		lock.lock();
+		pending = false;
+		finished.notify_one();
+	}
+}
+
+ArtNetEndpoint::~ArtNetEndpoint() {
+	if (receiver.joinable()) {
+		receiver_stop = true;
+		receiver.join();
+	}
+	socket.close();
+}
+
+bool ArtNetEndpoint::open() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (open_count == 0 && !socket.open(bind_address)) {
+		const uint8_t *ip = reinterpret_cast<const uint8_t *>(&bind_address.ip);
+		ArtNetLog::get_singleton().write(ARTNET_LOG_ERROR, "could not open a socket on %lld.%lld.%lld.%lld:%lld", ip[0], ip[1], ip[2], ip[3], bind_address.port);
+		return false;
+	}
+	open_count++;
+	return true;
+}
+
+void ArtNetEndpoint::close() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (open_count == 0) {
+		return;
+	}
+	if (--open_count == 0) {
+		socket.close();
+	}
+}
+
+bool ArtNetEndpoint::claim_universe(uint16_t port_address, const void *owner) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto result = owners.emplace(port_address, owner);
+	return result.first->second == owner;
+}
+
+void ArtNetEndpoint::release_universes(const void *owner) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto it = owners.begin(); it != owners.end();) {
+		if (it->second == owner) {
+			it = owners.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void ArtNetEndpoint::acquire_receiver() {
+	if (receiver_users++ == 0) {
+		receiver_stop = false;
+		receiver = std::thread(&ArtNetEndpoint::receiver_loop, this);
+	}
+}
+
+void ArtNetEndpoint::release_receiver() {
+	if (receiver_users > 0 && --receiver_users == 0) {
+		receiver_stop = true;
+		receiver.join();
+	}
+}
+
+bool ArtNetEndpoint::start_discovery(const ArtNetAddress &destination, double poll_interval_seconds) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!socket.is_open()) {
+		return false;
+	}
+	if (discovery_users++ > 0) {
+		return true;
+	}
+	{
+		std::lock_guard<std::mutex> dispatch(dispatch_mutex);
+		poll_destination = destination;
+		poll_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::max(poll_interval_seconds, 0.5)));
+		discovery.clear();
+		polling = true;
+	}
+	acquire_receiver();
+	return true;
+}
+
+void ArtNetEndpoint::stop_discovery() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (discovery_users == 0 || --discovery_users > 0) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> dispatch(dispatch_mutex);
+		polling = false;
+		discovery.clear();
+	}
+	release_receiver();
+}
+
+void ArtNetEndpoint::add_input(ArtNetInput *input) {
+	std::lock_guard<std::mutex> lock(mutex);
+	{
+		std::lock_guard<std::mutex> dispatch(dispatch_mutex);
+		inputs.push_back(input);
+	}
+	acquire_receiver();
+}
+
+void ArtNetEndpoint::remove_input(ArtNetInput *input) {
+	std::lock_guard<std::mutex> lock(mutex);
+	{
+		std::lock_guard<std::mutex> dispatch(dispatch_mutex);
+		inputs.erase(std::remove(inputs.begin(), inputs.end(), input), inputs.end());
+	}
+	release_receiver();
+}
+
+void ArtNetEndpoint::receiver_loop() {
+	using Clock = std::chrono::steady_clock;
+
+	uint8_t poll[ARTNET_POLL_SIZE];
+	artnet_write_poll(poll, ARTNET_POLL_FLAG_REPLY_ON_CHANGE);
+
+	// Large enough for any Art-Net packet, including a full ArtDmx.
+	uint8_t packet[1024];
+	Clock::time_point next_poll = Clock::now();
+
+	while (!receiver_stop) {
+		Clock::time_point now = Clock::now();
+		if (polling.load(std::memory_order_relaxed) && now >= next_poll) {
+			std::lock_guard<std::mutex> dispatch(dispatch_mutex);
+			if (polling.load(std::memory_order_relaxed)) {
+				socket.send_to(poll_destination, poll, sizeof(poll));
+				next_poll = now + poll_interval;
+				// Nodes that missed three polls in a row are treated as gone.
+				discovery.expire(now, poll_interval * 3);
+			}
+		}
+
+		ArtNetAddress from;
+		int size = socket.receive(packet, sizeof(packet), from, 100);
+		if (size <= 0) {
+			continue;
+		}
+		uint16_t opcode = artnet_read_opcode(packet, static_cast<size_t>(size));
+		if (opcode != ARTNET_OP_POLL_REPLY && opcode != ARTNET_OP_DMX) {
+			continue;
+		}
+		std::lock_guard<std::mutex> dispatch(dispatch_mutex);
+		Clock::time_point received = Clock::now();
+		if (opcode == ARTNET_OP_POLL_REPLY) {
+			if (polling.load(std::memory_order_relaxed)) {
+				discovery.handle_poll_reply(packet, static_cast<size_t>(size), from, received);
+			}
+		} else {
+			for (ArtNetInput *input : inputs) {
+				input->handle_dmx(packet, static_cast<size_t>(size), from, received);
+			}
+		}
+	}
+}
+
+ArtNetTransport &ArtNetTransport::get_singleton() {
+	static ArtNetTransport transport;
+	return transport;
+}
+
+std::shared_ptr<ArtNetEndpoint> ArtNetTransport::get_endpoint(const ArtNetAddress &bind_address, uint32_t index) {
+	std::lock_guard<std::mutex> lock(endpoints_mutex);
+	std::weak_ptr<ArtNetEndpoint> &slot = endpoints[std::make_tuple(bind_address.ip, bind_address.port, index)];
+	std::shared_ptr<ArtNetEndpoint> endpoint = slot.lock();
+	if (!endpoint) {
+		endpoint = std::make_shared<ArtNetEndpoint>(bind_address);
+		slot = endpoint;
+	}
+	return endpoint;
+}
+
+void ArtNetTransport::add_output(ArtNetOutput *output, bool realtime_priority) {
+	std::lock_guard<std::mutex> control(control_mutex);
+	{
+		std::lock_guard<std::mutex> lock(sender_mutex);
+		outputs.push_back(output);
+		outputs_changed = true;
+		realtime_requested = realtime_requested || realtime_priority;
+	}
+	if (!sender.joinable()) {
+		sender_stop = false;
+		sender = std::thread(&ArtNetTransport::sender_loop, this);
+	}
+	wake.notify_all();
+}
+
+void ArtNetTransport::remove_output(ArtNetOutput *output) {
+	std::lock_guard<std::mutex> control(control_mutex);
+	bool last = false;
+	{
+		// Taking the lock waits out a tick that is in progress.
+		std::lock_guard<std::mutex> lock(sender_mutex);
+		outputs.erase(std::remove(outputs.begin(), outputs.end(), output), outputs.end());
+		outputs_changed = true;
+		last = outputs.empty();
+		if (last) {
+			sender_stop = true;
+		}
+	}
+	wake.notify_all();
+	if (last && sender.joinable()) {
+		sender.join();
+		realtime_requested = false;
+	}
+}
+
+void ArtNetTransport::wake_sender() {
+	{
+		std::lock_guard<std::mutex> lock(sender_mutex);
+		outputs_changed = true;
+	}
+	wake.notify_all();
+}
+
+void ArtNetTransport::register_output(ArtNetOutput *output) {
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	registry.push_back(output);
+}
+
+void ArtNetTransport::unregister_output(ArtNetOutput *output) {
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	registry.erase(std::remove(registry.begin(), registry.end(), output), registry.end());
+}
+
+void ArtNetTransport::shutdown() {
+	std::lock_guard<std::mutex> control(control_mutex);
+	{
+		std::lock_guard<std::mutex> lock(sender_mutex);
+		outputs.clear();
+		sender_stop = true;
+	}
+	wake.notify_all();
+	if (sender.joinable()) {
+		sender.join();
+	}
+}
+
+size_t ArtNetTransport::get_open_socket_count() {
+	std::lock_guard<std::mutex> lock(endpoints_mutex);
+	size_t count = 0;
+	for (const auto &entry : endpoints) {
+		std::shared_ptr<ArtNetEndpoint> endpoint = entry.second.lock();
+		if (endpoint && endpoint->is_open()) {
+			count++;
+		}
+	}
+	return count;
+}
+
+size_t ArtNetTransport::get_active_output_count() {
+	std::lock_guard<std::mutex> lock(sender_mutex);
+	return outputs.size();
+}
+
+bool ArtNetTransport::is_sender_running() {
+	std::lock_guard<std::mutex> control(control_mutex);
+	return sender.joinable();
+}
+
+double ArtNetTransport::get_oldest_send_age() {
+	std::lock_guard<std::mutex> lock(registry_mutex);
+	double oldest = -1.0;
+	for (const ArtNetOutput *output : registry) {
+		// A stopped output's universes are expected to go stale.
+		if (!output->is_open() || !output->is_enabled()) {
+			continue;
+		}
+		oldest = std::max(oldest, output->get_oldest_send_age());
+	}
+	return oldest;
+}
+
+void ArtNetTransport::sender_loop() {
+	using Clock = std::chrono::steady_clock;
+
+	bool realtime_applied = false;
+
+	std::unique_lock<std::mutex> lock(sender_mutex);
+	while (!sender_stop) {
+		if (realtime_requested && !realtime_applied) {
+			artnet_set_current_thread_realtime();
+			realtime_applied = true;
+		}
+		outputs_changed = false;
+		if (outputs.empty()) {
+			wake.wait(lock, [this] { return sender_stop || outputs_changed; });
+			continue;
+		}
+
+		// Sleep until the earliest output deadline, or until the output set changes.
+		Clock::time_point deadline = Clock::time_point::max();
+		Clock::time_point scheduled = Clock::time_point::max();
+		for (ArtNetOutput *output : outputs) {
+			deadline = std::min(deadline, output->get_next_tick());
+			scheduled = std::min(scheduled, output->get_next_scheduled());
+		}
+		bool precise = scheduled <= deadline;
+		deadline = std::min(deadline, scheduled);
+		Clock::time_point wake_at = precise ? deadline - wake_lead : deadline;
+		bool slept = Clock::now() < wake_at;
+		if (wake.wait_until(lock, wake_at, [this] { return sender_stop || outputs_changed; })) {
+			continue;
+		}
+
+		if (precise) {
+			// Learn the wakeup latency, then yield through what is left of the lead.
+			Clock::time_point woke = Clock::now();
+			if (slept && woke > wake_at) {
+				wake_lead += (std::chrono::duration_cast<std::chrono::nanoseconds>(woke - wake_at) - wake_lead) / 8;
+				wake_lead = std::min<std::chrono::nanoseconds>(wake_lead, MAX_WAKE_LEAD);
+			}
+			if (woke < deadline) {
+				lock.unlock();
+				while (Clock::now() < deadline) {
+					std::this_thread::yield();
+				}
+				lock.lock();
+				if (sender_stop || outputs_changed) {
+					continue;
+				}
+			}
+		}
+
+		Clock::time_point now = Clock::now();
+		for (ArtNetOutput *output : outputs) {
+			if (output->get_next_tick() <= now || output->get_next_scheduled() <= now) {
+				output->tick(now);
+			}
+		}
+	}
+}
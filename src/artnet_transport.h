@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "artnet_discovery.h"
+#include "artnet_socket.h"
+
+class ArtNetInput;
+class ArtNetOutput;
+
+// Moves the calling thread to SCHED_FIFO. Failure (e.g. missing
+// CAP_SYS_NICE) is not fatal; the thread just keeps its normal priority.
+bool artnet_set_current_thread_realtime();
+// Restricts the calling thread to one CPU. Returns false where the platform
+// has no hard affinity (macOS) or the CPU does not exist.
+bool artnet_pin_current_thread(int cpu);
+
+// Worker thread that runs a fixed task each time it is posted. The poster
+// waits for the task to finish before touching what the task uses, so the
+// hand-off needs no other synchronization.
+class ArtNetShardWorker {
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	std::function<void()> task;
+	bool stop_requested = false;
+	bool pending = false;
+	int cpu = -1;
+	std::atomic<bool> realtime_requested{ false };
+	std::atomic<bool> pinned{ false };
+
+	void loop();
+
+public:
+	~ArtNetShardWorker() { stop(); }
+
+	// Starts the thread, pinned to cpu unless it is negative.
+	void start(int p_cpu, std::function<void()> p_task);
+	void stop();
+	bool is_running() const { return thread.joinable(); }
+	bool is_pinned() const { return pinned.load(std::memory_order_relaxed); }
+	// Applied before the next task runs.
+	void set_realtime(bool enable) { realtime_requested.store(enable, std::memory_order_relaxed); }
+
+	void post();
+	void wait();
+};
+
+// One UDP socket per local bind address, shared by every output bound to it.
+// The endpoint also records which output owns each Port-Address, so two
+// outputs on the same socket never send the same universe, and runs the
+// receive thread used for discovery and for incoming ArtDmx.
+class ArtNetEndpoint {
+	ArtNetAddress bind_address;
+	ArtNetSocket socket;
+
+	// Control path only (open/close, ownership, discovery start/stop).
+	std::mutex mutex;
+	int open_count = 0;
+	std::unordered_map<uint16_t, const void *> owners;
+
+	// The receive thread runs while discovery or any input needs it.
+	std::thread receiver;
+	std::atomic<bool> receiver_stop{ false };
+	int receiver_users = 0;
+
+	ArtNetDiscovery discovery;
+	std::atomic<bool> polling{ false };
+	int discovery_users = 0;
+	ArtNetAddress poll_destination;
+	std::chrono::steady_clock::duration poll_interval = std::chrono::seconds(3);
+
+	// Held by the receive thread while it handles a packet or sends a poll, so
+	// removing an input or changing discovery waits until the thread is done.
+	std::mutex dispatch_mutex;
+	std::vector<ArtNetInput *> inputs;
+
+	void acquire_receiver();
+	void release_receiver();
+	void receiver_loop();
+
+public:
+	explicit ArtNetEndpoint(const ArtNetAddress &p_bind_address) :
+			bind_address(p_bind_address) {}
+	~ArtNetEndpoint();
+
+	const ArtNetAddress &get_bind_address() const { return bind_address; }
+
+	// Reference counted: the socket is opened by the first caller and closed
+	// when the last one closes it.
+	bool open();
+	void close();
+	bool is_open() const { return socket.is_open(); }
+	ArtNetSocket &get_socket() { return socket; }
+
+	// Returns false if another owner already sends this Port-Address here.
+	bool claim_universe(uint16_t port_address, const void *owner);
+	void release_universes(const void *owner);
+
+	// Shared by every output on the endpoint. The first caller's poll
+	// destination and interval are used until the last one stops.
+	bool start_discovery(const ArtNetAddress &destination, double poll_interval_seconds);
+	void stop_discovery();
+	std::shared_ptr<const ArtNetRoutingTable> get_routing_table() const { return discovery.get_routing_table(); }
+	std::shared_ptr<const ArtNetNodeTable> get_node_table() const { return discovery.get_node_table(); }
+
+	// Inputs receive every ArtDmx packet that arrives on the socket.
+	void add_input(ArtNetInput *input);
+	void remove_input(ArtNetInput *input);
+};
+
+// Process-wide transport shared by every ArtNetOutput: hands out endpoints
+// keyed by bind address and runs a single sender thread that ticks each
+// registered output at its own refresh rate.
+class ArtNetTransport {
+	std::mutex endpoints_mutex;
+	std::map<std::tuple<uint32_t, uint16_t, uint32_t>, std::weak_ptr<ArtNetEndpoint>> endpoints;
+
+	// Serializes add/remove/shutdown so the thread is started and joined from one place.
+	std::mutex control_mutex;
+
+	// Held by the sender thread while it ticks outputs; released while it sleeps.
+	std::mutex sender_mutex;
+	std::condition_variable wake;
+	std::thread sender;
+	bool sender_stop = false;
+	bool outputs_changed = false; // also set to make the thread recompute its deadline
+	bool realtime_requested = false;
+	std::vector<ArtNetOutput *> outputs;
+
+	// Scheduled frames need their exact time, not the next timer wakeup after
+	// it: the thread sleeps until wake_lead before such a deadline and yields
+	// for the rest. wake_lead tracks how late the OS wakes the thread.
+	static constexpr std::chrono::microseconds MAX_WAKE_LEAD{ 1000 };
+	std::chrono::nanoseconds wake_lead{ 0 }; // sender thread only
+
+	// Every live output, sending or not, for process-wide queries.
+	std::mutex registry_mutex;
+	std::vector<ArtNetOutput *> registry;
+
+	void sender_loop();
+
+public:
+	static ArtNetTransport &get_singleton();
+
+	// index picks one of several sockets on the same address; sharded
+	// outputs use it to send from more than one socket per interface.
+	std::shared_ptr<ArtNetEndpoint> get_endpoint(const ArtNetAddress &bind_address, uint32_t index = 0);
+
+	// Starts ticking output on the shared sender thread. When remove_output()
+	// returns, the thread is no longer touching the output.
+	void add_output(ArtNetOutput *output, bool realtime_priority);
+	void remove_output(ArtNetOutput *output);
+	// Makes the sender thread re-read every output's next deadline.
+	void wake_sender();
+
+	// Called from the ArtNetOutput constructor and destructor.
+	void register_output(ArtNetOutput *output);
+	void unregister_output(ArtNetOutput *output);
+
+	// Stops the sender thread. Called when the extension is unloaded.
+	void shutdown();
+
+	size_t get_open_socket_count();
+	size_t get_active_output_count();
+	bool is_sender_running();
+
+	// Seconds since the least recently sent universe of any output went out,
+	// or a negative value if nothing has been sent. Walks the outputs' universe
+	// lists, so call it from the thread that creates universes.
+	double get_oldest_send_age();
+};
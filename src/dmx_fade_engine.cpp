@@ -0,0 +1,293 @@
+#include "dmx_fade_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "artnet_output.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DMX_FADE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DMX_FADE_NEON
+#endif
+
+uint32_t dmx_fade_weight(DmxFadeCurve curve, double progress) {
+	double p = std::min(std::max(progress, 0.0), 1.0);
+	double eased = p;
+	switch (curve) {
+		case DMX_FADE_EASE_IN:
+			eased = p * p;
+			break;
+		case DMX_FADE_EASE_OUT:
+			eased = p * (2.0 - p);
+			break;
+		case DMX_FADE_EASE_IN_OUT:
+			eased = p * p * (3.0 - 2.0 * p);
+			break;
+		default:
+			break;
+	}
+	return static_cast<uint32_t>(std::lround(eased * 256.0));
+}
+
+void dmx_fade_blend(uint8_t *out, const uint8_t *from, const uint8_t *to, uint32_t weight, size_t count) {
+	// from * (256 - w) + to * w + 128 stays below 65536, so 16-bit lanes are enough.
+	uint16_t w = static_cast<uint16_t>(std::min<uint32_t>(weight, 256));
+	uint16_t inverse = static_cast<uint16_t>(256 - w);
+	size_t i = 0;
+#if defined(DMX_FADE_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i to_weight = _mm_set1_epi16(static_cast<short>(w));
+	const __m128i from_weight = _mm_set1_epi16(static_cast<short>(inverse));
+	const __m128i round = _mm_set1_epi16(128);
+	for (; i + 16 <= count; i += 16) {
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(from + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(to + i));
+		__m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), from_weight), _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), to_weight));
+		__m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), from_weight), _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), to_weight));
+		low = _mm_srli_epi16(_mm_add_epi16(low, round), 8);
+		high = _mm_srli_epi16(_mm_add_epi16(high, round), 8);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(low, high));
+	}
+#elif defined(DMX_FADE_NEON)
+	for (; i + 16 <= count; i += 16) {
+		uint8x16_t a = vld1q_u8(from + i);
+		uint8x16_t b = vld1q_u8(to + i);
+		uint16x8_t low = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(a)), inverse), vmovl_u8(vget_low_u8(b)), w);
+		uint16x8_t high = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(a)), inverse), vmovl_u8(vget_high_u8(b)), w);
+		vst1q_u8(out + i, vcombine_u8(vrshrn_n_u16(low, 8), vrshrn_n_u16(high, 8)));
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = static_cast<uint8_t>((from[i] * inverse + to[i] * w + 128u) >> 8);
+	}
+}
+
+void dmx_fade_merge(uint8_t *out, const uint8_t *base, const uint8_t *value, const uint8_t *mask, size_t count) {
+	size_t i = 0;
+#if defined(DMX_FADE_SSE2)
+	for (; i + 16 <= count; i += 16) {
+		__m128i m = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + i));
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(value + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(base + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, b)));
+	}
+#elif defined(DMX_FADE_NEON)
+	for (; i + 16 <= count; i += 16) {
+		vst1q_u8(out + i, vbslq_u8(vld1q_u8(mask + i), vld1q_u8(value + i), vld1q_u8(base + i)));
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = static_cast<uint8_t>((value[i] & mask[i]) | (base[i] & ~mask[i]));
+	}
+}
+
+void DmxFadeEngine::reserve(size_t capacity) {
+	commands.reserve(capacity);
+	reset();
+}
+
+void DmxFadeEngine::reset() {
+	commands.reset();
+	for (DmxFadeState *state : active_states) {
+		state->universe->fade = nullptr;
+		state->active = false;
+	}
+	active_states.clear();
+	states.clear();
+	running_fades.store(0, std::memory_order_relaxed);
+}
+
+bool DmxFadeEngine::fade(DmxUniverseBuffer *universe, uint16_t channel, const uint8_t *targets, uint16_t count, int64_t start_usec, int64_t duration_usec, DmxFadeCurve curve) {
+	DmxFadeCommand *command = commands.prepare(0);
+	if (!command) {
+		return false;
+	}
+	command->type = DmxFadeCommand::FADE;
+	command->universe = universe;
+	command->channel = channel;
+	command->count = count;
+	command->start_usec = start_usec;
+	command->duration_usec = duration_usec;
+	command->curve = curve;
+	std::memcpy(command->targets, targets, count);
+	commands.push(1);
+	return true;
+}
+
+bool DmxFadeEngine::fill(DmxUniverseBuffer *universe, uint16_t channel, uint8_t target, uint16_t count, int64_t start_usec, int64_t duration_usec, DmxFadeCurve curve) {
+	uint8_t targets[DMX_UNIVERSE_SIZE];
+	std::memset(targets, target, count);
+	return fade(universe, channel, targets, count, start_usec, duration_usec, curve);
+}
+
+bool DmxFadeEngine::release(DmxUniverseBuffer *universe, uint16_t channel, uint16_t count) {
+	DmxFadeCommand *command = commands.prepare(0);
+	if (!command) {
+		return false;
+	}
+	command->type = DmxFadeCommand::RELEASE;
+	command->universe = universe;
+	command->channel = channel;
+	command->count = count;
+	commands.push(1);
+	return true;
+}
+
+bool DmxFadeEngine::release_all() {
+	DmxFadeCommand *command = commands.prepare(0);
+	if (!command) {
+		return false;
+	}
+	command->type = DmxFadeCommand::RELEASE_ALL;
+	command->universe = nullptr;
+	commands.push(1);
+	return true;
+}
+
+DmxFadeState *DmxFadeEngine::acquire_state(DmxUniverseBuffer *universe) {
+	if (universe->fade) {
+		return universe->fade;
+	}
+	DmxFadeState *state = nullptr;
+	for (const std::unique_ptr<DmxFadeState> &candidate : states) {
+		if (!candidate->active) {
+			state = candidate.get();
+			break;
+		}
+	}
+	if (!state) {
+		// Only the first fade on a universe allocates.
+		states.push_back(std::make_unique<DmxFadeState>());
+		state = states.back().get();
+	}
+	state->universe = universe;
+	std::memset(state->held, 0, sizeof(state->held));
+	state->extent = 0;
+	state->fades.clear();
+	state->changed = false;
+	state->active = true;
+	active_states.push_back(state);
+	universe->fade = state;
+	return state;
+}
+
+void DmxFadeEngine::cut(DmxFadeState &state, uint16_t begin, uint16_t end) {
+	// Pieces split off here lie outside [begin, end), so visiting them again is harmless.
+	std::vector<DmxFadeState::Fade> &fades = state.fades;
+	for (size_t i = 0; i < fades.size();) {
+		DmxFadeState::Fade &fade = fades[i];
+		if (fade.end <= begin || fade.begin >= end) {
+			i++;
+		} else if (fade.begin >= begin && fade.end <= end) {
+			fade = fades.back();
+			fades.pop_back();
+		} else if (fade.begin < begin && fade.end > end) {
+			DmxFadeState::Fade tail = fade;
+			tail.begin = end;
+			fade.end = begin;
+			fades.push_back(tail);
+			i++;
+		} else {
+			if (fade.begin < begin) {
+				fade.end = begin;
+			} else {
+				fade.begin = end;
+			}
+			i++;
+		}
+	}
+}
+
+void DmxFadeEngine::release(DmxFadeState &state, uint16_t begin, uint16_t end) {
+	cut(state, begin, end);
+	std::memset(state.held + begin, 0, end - begin);
+	while (state.extent > 0 && !state.held[state.extent - 1]) {
+		state.extent--;
+	}
+	state.changed = true;
+}
+
+void DmxFadeEngine::apply(const DmxFadeCommand &command, int frame) {
+	if (command.type == DmxFadeCommand::RELEASE_ALL) {
+		for (DmxFadeState *state : active_states) {
+			release(*state, 0, static_cast<uint16_t>(DMX_UNIVERSE_SIZE));
+		}
+		return;
+	}
+	uint16_t begin = command.channel;
+	uint16_t end = static_cast<uint16_t>(command.channel + command.count);
+	if (command.type == DmxFadeCommand::RELEASE) {
+		if (command.universe->fade) {
+			release(*command.universe->fade, begin, end);
+		}
+		return;
+	}
+
+	DmxFadeState &state = *acquire_state(command.universe);
+	cut(state, begin, end);
+	// Running and finished fades continue from where they are; other channels
+	// start from what the game last committed.
+	const uint8_t *base = command.universe->frames[frame];
+	dmx_fade_merge(state.from + begin, base + begin, state.value + begin, state.held + begin, command.count);
+	std::memcpy(state.value + begin, state.from + begin, command.count);
+	std::memcpy(state.to + begin, command.targets, command.count);
+	std::memset(state.held + begin, 0xFF, command.count);
+	state.extent = std::max(state.extent, end);
+
+	DmxFadeState::Fade fade;
+	fade.begin = begin;
+	fade.end = end;
+	fade.curve = command.curve;
+	fade.start_usec = command.start_usec;
+	fade.duration_usec = command.duration_usec;
+	state.fades.push_back(fade);
+	state.changed = true;
+}
+
+void DmxFadeEngine::update(int64_t now_usec, int frame) {
+	for (const DmxFadeCommand *command = commands.front(); command; command = commands.front()) {
+		apply(*command, frame);
+		commands.pop();
+	}
+
+	size_t running = 0;
+	for (DmxFadeState *state : active_states) {
+		std::vector<DmxFadeState::Fade> &fades = state->fades;
+		for (size_t i = 0; i < fades.size();) {
+			const DmxFadeState::Fade &fade = fades[i];
+			size_t count = fade.end - fade.begin;
+			int64_t elapsed = now_usec - fade.start_usec;
+			state->changed = true;
+			if (elapsed >= fade.duration_usec) {
+				// Finished: the channels hold their target until released.
+				std::memcpy(state->value + fade.begin, state->to + fade.begin, count);
+				fades[i] = fades.back();
+				fades.pop_back();
+				continue;
+			}
+			double progress = static_cast<double>(elapsed) / static_cast<double>(fade.duration_usec);
+			dmx_fade_blend(state->value + fade.begin, state->from + fade.begin, state->to + fade.begin, dmx_fade_weight(fade.curve, progress), count);
+			running++;
+			i++;
+		}
+	}
+	running_fades.store(running, std::memory_order_relaxed);
+}
+
+void DmxFadeEngine::prune() {
+	for (size_t i = 0; i < active_states.size();) {
+		DmxFadeState *state = active_states[i];
+		if (state->extent > 0 || state->changed) {
+			i++;
+			continue;
+		}
+		state->universe->fade = nullptr;
+		state->active = false;
+		active_states[i] = active_states.back();
+		active_states.pop_back();
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "artnet_protocol.h"
+#include "dmx_schedule_queue.h"
+
+struct DmxUniverseBuffer;
+
+enum DmxFadeCurve {
+	DMX_FADE_LINEAR,
+	DMX_FADE_EASE_IN,
+	DMX_FADE_EASE_OUT,
+	DMX_FADE_EASE_IN_OUT,
+	DMX_FADE_CURVE_MAX,
+};
+
+// Blend weight (0-256) of a curve at progress 0..1.
+uint32_t dmx_fade_weight(DmxFadeCurve curve, double progress);
+
+// out[i] = from[i] + (to[i] - from[i]) * weight / 256, rounded. Vectorized
+// with SSE2 or NEON when available.
+void dmx_fade_blend(uint8_t *out, const uint8_t *from, const uint8_t *to, uint32_t weight, size_t count);
+// out[i] = mask[i] ? value[i] : base[i] for masks of 0x00 or 0xFF.
+void dmx_fade_merge(uint8_t *out, const uint8_t *base, const uint8_t *value, const uint8_t *mask, size_t count);
+
+// A fade or release request, passed from the game thread to the sender thread.
+struct DmxFadeCommand {
+	enum Type : uint8_t {
+		FADE,
+		RELEASE,
+		RELEASE_ALL,
+	};
+
+	DmxUniverseBuffer *universe = nullptr;
+	int64_t start_usec = 0;
+	int64_t duration_usec = 0;
+	uint16_t channel = 0;
+	uint16_t count = 0;
+	Type type = FADE;
+	DmxFadeCurve curve = DMX_FADE_LINEAR;
+	uint8_t targets[DMX_UNIVERSE_SIZE];
+};
+
+// Channels of one universe held by the fade engine. Channels whose fade has
+// finished stay at their target until released.
+struct DmxFadeState {
+	struct Fade {
+		uint16_t begin = 0;
+		uint16_t end = 0;
+		DmxFadeCurve curve = DMX_FADE_LINEAR;
+		int64_t start_usec = 0;
+		int64_t duration_usec = 0;
+	};
+
+	DmxUniverseBuffer *universe = nullptr;
+	alignas(16) uint8_t from[DMX_UNIVERSE_SIZE] = {};
+	alignas(16) uint8_t to[DMX_UNIVERSE_SIZE] = {};
+	alignas(16) uint8_t value[DMX_UNIVERSE_SIZE] = {}; // current level of every held channel
+	alignas(16) uint8_t held[DMX_UNIVERSE_SIZE] = {}; // 0xFF where value overrides the committed frame
+	uint16_t extent = 0; // one past the last held channel
+	std::vector<Fade> fades; // running fades, non-overlapping
+	bool changed = false; // value or held set changed since the universe was last sent
+	bool active = false;
+};
+
+// Per-channel fades computed on the sender thread. The game thread queues
+// commands; every periodic pass the sender thread applies them, advances
+// each running fade to the current time and merges the held channels over
+// the committed frame, so fades run at the output rate whatever the game's
+// frame rate. Nothing is allocated per tick once a universe has been faded.
+class DmxFadeEngine {
+	DmxFrameQueue<DmxFadeCommand> commands;
+	std::vector<std::unique_ptr<DmxFadeState>> states; // every state ever created, reused
+	std::vector<DmxFadeState *> active_states;
+	std::atomic<size_t> running_fades{ 0 };
+
+	DmxFadeState *acquire_state(DmxUniverseBuffer *universe);
+	// Stops the running fades over [begin, end); parts outside it keep running.
+	static void cut(DmxFadeState &state, uint16_t begin, uint16_t end);
+	void apply(const DmxFadeCommand &command, int frame);
+	void release(DmxFadeState &state, uint16_t begin, uint16_t end);
+
+public:
+	// Sizes the command queue and drops every fade. Only call while the sender
+	// thread is not running this engine.
+	void reserve(size_t capacity);
+	void reset();
+
+	// Game thread: queues a command. Returns false when the queue is full.
+	bool fade(DmxUniverseBuffer *universe, uint16_t channel, const uint8_t *targets, uint16_t count, int64_t start_usec, int64_t duration_usec, DmxFadeCurve curve);
+	bool fill(DmxUniverseBuffer *universe, uint16_t channel, uint8_t target, uint16_t count, int64_t start_usec, int64_t duration_usec, DmxFadeCurve curve);
+	bool release(DmxUniverseBuffer *universe, uint16_t channel, uint16_t count);
+	bool release_all();
+
+	// Sender thread: applies queued commands, capturing the starting level of
+	// channels not held yet from frame, then advances every fade to now_usec.
+	void update(int64_t now_usec, int frame);
+	// Universes with held channels, or released since they were last sent.
+	const std::vector<DmxFadeState *> &get_states() const { return active_states; }
+	// Forgets states that hold nothing and have been sent since their release.
+	void prune();
+
+	// Fades still in progress as of the last pass; readable from any thread.
+	size_t get_running_fade_count() const { return running_fades.load(std::memory_order_relaxed); }
+};
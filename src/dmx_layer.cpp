@@ -0,0 +1,121 @@
+#include "dmx_layer.h"
+
+#include <algorithm>
+
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+
+void DmxLayer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("is_valid"), &DmxLayer::is_valid);
+	ClassDB::bind_method(D_METHOD("set_channel", "universe", "channel", "value"), &DmxLayer::set_channel);
+	ClassDB::bind_method(D_METHOD("set_channels", "universe", "channel", "values"), &DmxLayer::set_channels);
+	ClassDB::bind_method(D_METHOD("fill_channels", "universe", "channel", "count", "value"), &DmxLayer::fill_channels);
+	ClassDB::bind_method(D_METHOD("clear_channels", "universe", "channel", "count"), &DmxLayer::clear_channels, DEFVAL(0), DEFVAL(512));
+	ClassDB::bind_method(D_METHOD("clear"), &DmxLayer::clear);
+	ClassDB::bind_method(D_METHOD("get_channel", "universe", "channel"), &DmxLayer::get_channel);
+	ClassDB::bind_method(D_METHOD("set_priority", "priority"), &DmxLayer::set_priority);
+	ClassDB::bind_method(D_METHOD("get_priority"), &DmxLayer::get_priority);
+	ClassDB::bind_method(D_METHOD("set_mode", "mode"), &DmxLayer::set_mode);
+	ClassDB::bind_method(D_METHOD("get_mode"), &DmxLayer::get_mode);
+	ClassDB::bind_method(D_METHOD("set_opacity", "opacity"), &DmxLayer::set_opacity);
+	ClassDB::bind_method(D_METHOD("get_opacity"), &DmxLayer::get_opacity);
+	ClassDB::bind_method(D_METHOD("set_enabled", "enable"), &DmxLayer::set_enabled);
+	ClassDB::bind_method(D_METHOD("is_enabled"), &DmxLayer::is_enabled);
+
+	BIND_ENUM_CONSTANT(MODE_HTP);
+	BIND_ENUM_CONSTANT(MODE_LTP);
+}
+
+void DmxLayer::setup(const Ref<RefCounted> &p_owner, const std::shared_ptr<DmxMergeLayer> &p_layer) {
+	owner = p_owner;
+	layer = p_layer;
+}
+
+bool DmxLayer::is_valid() const {
+	return layer && layer->is_attached();
+}
+
+bool DmxLayer::set_channel(int universe, int channel, int value) {
+	if (!layer || universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE)) {
+		return false;
+	}
+	uint8_t level = static_cast<uint8_t>(std::clamp(value, 0, 255));
+	return layer->set_channels(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), &level, 1);
+}
+
+bool DmxLayer::set_channels(int universe, int channel, const PackedByteArray &values) {
+	if (!layer || universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE)) {
+		return false;
+	}
+	return layer->set_channels(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), values.ptr(), static_cast<size_t>(values.size()));
+}
+
+bool DmxLayer::fill_channels(int universe, int channel, int count, int value) {
+	if (!layer || universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE) || count < 0) {
+		return false;
+	}
+	return layer->fill_channels(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), static_cast<size_t>(count), static_cast<uint8_t>(std::clamp(value, 0, 255)));
+}
+
+bool DmxLayer::clear_channels(int universe, int channel, int count) {
+	if (!layer || universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE) || count <= 0) {
+		return false;
+	}
+	// Clamp so the default count clears everything from channel on.
+	size_t available = DMX_UNIVERSE_SIZE - static_cast<size_t>(channel);
+	return layer->clear_channels(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), std::min(static_cast<size_t>(count), available));
+}
+
+void DmxLayer::clear() {
+	if (layer) {
+		layer->clear();
+	}
+}
+
+int DmxLayer::get_channel(int universe, int channel) const {
+	if (!layer || universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE)) {
+		return -1;
+	}
+	return layer->get_channel(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel));
+}
+
+void DmxLayer::set_priority(int priority) {
+	if (layer) {
+		layer->set_priority(priority);
+	}
+}
+
+int DmxLayer::get_priority() const {
+	return layer ? layer->get_priority() : 0;
+}
+
+void DmxLayer::set_mode(Mode mode) {
+	if (layer) {
+		layer->set_mode(static_cast<DmxLayerMode>(mode));
+	}
+}
+
+DmxLayer::Mode DmxLayer::get_mode() const {
+	return layer ? static_cast<Mode>(layer->get_mode()) : MODE_HTP;
+}
+
+void DmxLayer::set_opacity(float opacity) {
+	if (layer) {
+		layer->set_opacity(opacity);
+	}
+}
+
+float DmxLayer::get_opacity() const {
+	return layer ? static_cast<float>(layer->get_opacity()) : 0.0f;
+}
+
+void DmxLayer::set_enabled(bool enable) {
+	if (layer) {
+		layer->set_enabled(enable);
+	}
+}
+
+bool DmxLayer::is_enabled() const {
+	return layer && layer->is_enabled();
+}
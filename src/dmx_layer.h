@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/packed_byte_array.hpp"
+
+#include "dmx_layer_stack.h"
+
+using namespace godot;
+
+// Handle to one layer of an ArtNetController's layer stack. Each source
+// (effects, UI overrides, a safety blackout) writes its own sparse layer;
+// the controller merges them natively when it sends.
+class DmxLayer : public RefCounted {
+	GDCLASS(DmxLayer, RefCounted)
+
+public:
+	enum Mode {
+		MODE_HTP = DMX_LAYER_HTP,
+		MODE_LTP = DMX_LAYER_LTP,
+	};
+
+protected:
+	static void _bind_methods();
+
+private:
+	Ref<RefCounted> owner; // keeps the controller that owns the stack alive
+	std::shared_ptr<DmxMergeLayer> layer;
+
+public:
+	void setup(const Ref<RefCounted> &p_owner, const std::shared_ptr<DmxMergeLayer> &p_layer);
+	DmxMergeLayer *get_layer() const { return layer.get(); }
+
+	bool is_valid() const;
+
+	bool set_channel(int universe, int channel, int value);
+	bool set_channels(int universe, int channel, const PackedByteArray &values);
+	bool fill_channels(int universe, int channel, int count, int value);
+	bool clear_channels(int universe, int channel = 0, int count = 512);
+	void clear();
+	int get_channel(int universe, int channel) const;
+
+	void set_priority(int priority);
+	int get_priority() const;
+	void set_mode(Mode mode);
+	Mode get_mode() const;
+	void set_opacity(float opacity);
+	float get_opacity() const;
+	void set_enabled(bool enable);
+	bool is_enabled() const;
+};
+
+VARIANT_ENUM_CAST(DmxLayer::Mode);
@@ -0,0 +1,291 @@
+#include "dmx_layer_stack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "artnet_output.h"
+#include "dmx_fade_engine.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DMX_LAYER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DMX_LAYER_NEON
+#endif
+
+void dmx_layer_max(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t count) {
+	size_t i = 0;
+#if defined(DMX_LAYER_SSE2)
+	for (; i + 16 <= count; i += 16) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+		__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_max_epu8(x, y));
+	}
+#elif defined(DMX_LAYER_NEON)
+	for (; i + 16 <= count; i += 16) {
+		vst1q_u8(out + i, vmaxq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = std::max(a[i], b[i]);
+	}
+}
+
+DmxLayerUniverse *DmxMergeLayer::get_universe(uint16_t port_address, uint16_t channel, size_t count) {
+	if (!stack || port_address > ARTNET_MAX_PORT_ADDRESS || count == 0 || channel + count > DMX_UNIVERSE_SIZE) {
+		return nullptr;
+	}
+	DmxLayerUniverse *universe = universes.find(port_address);
+	if (!universe) {
+		universe = universes.insert(port_address);
+		universe->port_address = port_address;
+		universe->layer = this;
+		universe->target = stack->get_target(port_address);
+		universe->target->sources.push_back(universe);
+		universe_list.push_back(universe);
+	}
+	return universe;
+}
+
+void DmxMergeLayer::touch(DmxLayerUniverse &universe) {
+	universe.written = ++stack->write_count;
+	stack->mark_dirty(*universe.target);
+}
+
+void DmxMergeLayer::touch_all() {
+	if (!stack) {
+		return;
+	}
+	for (DmxLayerUniverse *universe : universe_list) {
+		stack->mark_dirty(*universe->target);
+	}
+}
+
+bool DmxMergeLayer::set_channels(uint16_t port_address, uint16_t channel, const uint8_t *values, size_t count) {
+	DmxLayerUniverse *universe = get_universe(port_address, channel, count);
+	if (!universe) {
+		return false;
+	}
+	std::memcpy(universe->values + channel, values, count);
+	std::memset(universe->mask + channel, 0xFF, count);
+	universe->extent = std::max<uint16_t>(universe->extent, static_cast<uint16_t>(channel + count));
+	touch(*universe);
+	return true;
+}
+
+bool DmxMergeLayer::fill_channels(uint16_t port_address, uint16_t channel, size_t count, uint8_t value) {
+	DmxLayerUniverse *universe = get_universe(port_address, channel, count);
+	if (!universe) {
+		return false;
+	}
+	std::memset(universe->values + channel, value, count);
+	std::memset(universe->mask + channel, 0xFF, count);
+	universe->extent = std::max<uint16_t>(universe->extent, static_cast<uint16_t>(channel + count));
+	touch(*universe);
+	return true;
+}
+
+bool DmxMergeLayer::clear_channels(uint16_t port_address, uint16_t channel, size_t count) {
+	if (!stack || count == 0 || channel + count > DMX_UNIVERSE_SIZE) {
+		return false;
+	}
+	DmxLayerUniverse *universe = universes.find(port_address);
+	if (!universe) {
+		return true;
+	}
+	std::memset(universe->values + channel, 0, count);
+	std::memset(universe->mask + channel, 0, count);
+	while (universe->extent > 0 && !universe->mask[universe->extent - 1]) {
+		universe->extent--;
+	}
+	touch(*universe);
+	return true;
+}
+
+void DmxMergeLayer::clear() {
+	for (DmxLayerUniverse *universe : universe_list) {
+		clear_channels(universe->port_address, 0, DMX_UNIVERSE_SIZE);
+	}
+}
+
+int DmxMergeLayer::get_channel(uint16_t port_address, uint16_t channel) const {
+	if (channel >= DMX_UNIVERSE_SIZE) {
+		return -1;
+	}
+	const DmxLayerUniverse *universe = universes.find(port_address);
+	if (!universe || !universe->mask[channel]) {
+		return -1;
+	}
+	return universe->values[channel];
+}
+
+void DmxMergeLayer::set_priority(int p_priority) {
+	if (priority != p_priority) {
+		priority = p_priority;
+		touch_all();
+	}
+}
+
+void DmxMergeLayer::set_mode(DmxLayerMode p_mode) {
+	if (p_mode < DMX_LAYER_MODE_MAX && mode != p_mode) {
+		mode = p_mode;
+		touch_all();
+	}
+}
+
+void DmxMergeLayer::set_opacity(double p_opacity) {
+	uint32_t weight = static_cast<uint32_t>(std::lround(std::min(std::max(p_opacity, 0.0), 1.0) * 256.0));
+	if (opacity != weight) {
+		opacity = weight;
+		touch_all();
+	}
+}
+
+void DmxMergeLayer::set_enabled(bool enable) {
+	if (enabled != enable) {
+		enabled = enable;
+		touch_all();
+	}
+}
+
+DmxLayerStack::~DmxLayerStack() {
+	for (const std::shared_ptr<DmxMergeLayer> &layer : layers) {
+		layer->stack = nullptr;
+	}
+}
+
+std::shared_ptr<DmxMergeLayer> DmxLayerStack::create_layer(int priority, DmxLayerMode mode) {
+	if (mode >= DMX_LAYER_MODE_MAX) {
+		return nullptr;
+	}
+	std::shared_ptr<DmxMergeLayer> layer = std::make_shared<DmxMergeLayer>();
+	layer->stack = this;
+	layer->priority = priority;
+	layer->mode = mode;
+	layers.push_back(layer);
+	return layer;
+}
+
+bool DmxLayerStack::remove_layer(DmxMergeLayer *layer) {
+	if (!layer || layer->stack != this) {
+		return false;
+	}
+	for (DmxLayerUniverse *universe : layer->universe_list) {
+		std::vector<DmxLayerUniverse *> &sources = universe->target->sources;
+		sources.erase(std::remove(sources.begin(), sources.end(), universe), sources.end());
+		mark_dirty(*universe->target);
+	}
+	layer->stack = nullptr;
+	layers.erase(std::remove_if(layers.begin(), layers.end(), [layer](const std::shared_ptr<DmxMergeLayer> &entry) {
+		return entry.get() == layer;
+	}),
+			layers.end());
+	return true;
+}
+
+void DmxLayerStack::clear() {
+	while (!layers.empty()) {
+		remove_layer(layers.back().get());
+	}
+}
+
+DmxLayerTarget *DmxLayerStack::get_target(uint16_t port_address) {
+	DmxLayerTarget *target = targets.find(port_address);
+	if (!target) {
+		target = targets.insert(port_address);
+		target->port_address = port_address;
+	}
+	return target;
+}
+
+void DmxLayerStack::mark_dirty(DmxLayerTarget &target) {
+	if (!target.dirty) {
+		target.dirty = true;
+		dirty.push_back(&target);
+	}
+}
+
+void DmxLayerStack::merge(const DmxLayerTarget &target, const uint8_t *base, uint16_t base_length, uint8_t *out, uint16_t &r_length) {
+	// The output's slab is the lowest source.
+	std::memcpy(out, base, DMX_UNIVERSE_SIZE);
+	uint16_t extent = base_length;
+	for (const DmxLayerUniverse *source : target.sources) {
+		const DmxMergeLayer &layer = *source->layer;
+		size_t count = source->extent;
+		if (!layer.enabled || count == 0 || layer.opacity == 0) {
+			continue;
+		}
+		if (layer.mode == DMX_LAYER_HTP) {
+			// Channels the layer does not set are 0, so they never win.
+			const uint8_t *values = source->values;
+			if (layer.opacity < 256) {
+				dmx_fade_blend(scratch, zeros, source->values, layer.opacity, count);
+				values = scratch;
+			}
+			dmx_layer_max(out, out, values, count);
+		} else {
+			const uint8_t *values = source->values;
+			if (layer.opacity < 256) {
+				dmx_fade_blend(scratch, out, source->values, layer.opacity, count);
+				values = scratch;
+			}
+			dmx_fade_merge(out, out, values, source->mask, count);
+		}
+		extent = std::max(extent, source->extent);
+	}
+	r_length = artnet_dmx_length(extent);
+}
+
+size_t DmxLayerStack::update() {
+	size_t updated = 0;
+	for (DmxLayerTarget *target : dirty) {
+		target->dirty = false;
+		// Few layers touch one universe, so an insertion sort beats anything fancier.
+		std::vector<DmxLayerUniverse *> &sources = target->sources;
+		for (size_t i = 1; i < sources.size(); i++) {
+			DmxLayerUniverse *source = sources[i];
+			size_t j = i;
+			for (; j > 0; j--) {
+				DmxLayerUniverse *other = sources[j - 1];
+				if (other->layer->priority < source->layer->priority || (other->layer->priority == source->layer->priority && other->written <= source->written)) {
+					break;
+				}
+				sources[j] = other;
+			}
+			sources[j] = source;
+		}
+		target->active = std::any_of(sources.begin(), sources.end(), [](const DmxLayerUniverse *source) {
+			return source->extent > 0 && source->layer->enabled && source->layer->opacity > 0;
+		});
+		updated++;
+	}
+	dirty.clear();
+	return updated;
+}
+
+void DmxLayerStack::overlay(DmxUniverseBuffer *const *list, size_t count) {
+	update();
+	for (size_t i = 0; i < count; i++) {
+		DmxUniverseBuffer *universe = list[i];
+		DmxLayerTarget *target = targets.find(universe->port_address);
+		if (!target || !target->active || target->overlaid) {
+			continue;
+		}
+		std::memcpy(target->base, universe->data, DMX_UNIVERSE_SIZE);
+		target->base_length = universe->length;
+		target->overlaid = true;
+		merge(*target, target->base, target->base_length, universe->data, universe->length);
+		overlaid.emplace_back(target, universe);
+	}
+}
+
+void DmxLayerStack::restore() {
+	for (const std::pair<DmxLayerTarget *, DmxUniverseBuffer *> &entry : overlaid) {
+		std::memcpy(entry.second->data, entry.first->base, DMX_UNIVERSE_SIZE);
+		entry.second->length = entry.first->base_length;
+		entry.first->overlaid = false;
+	}
+	overlaid.clear();
+}
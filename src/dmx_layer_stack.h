@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "artnet_protocol.h"
+#include "dmx_universe_arena.h"
+
+struct DmxUniverseBuffer;
+class DmxMergeLayer;
+class DmxLayerStack;
+
+enum DmxLayerMode : uint8_t {
+	DMX_LAYER_HTP, // highest value wins over the layers below
+	DMX_LAYER_LTP, // replaces the layers below
+	DMX_LAYER_MODE_MAX,
+};
+
+// out[i] = max(a[i], b[i]). Vectorized with SSE2 or NEON when available.
+void dmx_layer_max(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t count);
+
+struct DmxLayerUniverse;
+
+// An output universe written by at least one layer.
+struct DmxLayerTarget {
+	alignas(16) uint8_t base[DMX_UNIVERSE_SIZE] = {}; // the output's own slab while the layers are merged over it
+	uint16_t base_length = DMX_UNIVERSE_SIZE;
+	uint16_t port_address = 0;
+	bool dirty = false;
+	bool active = false; // some source sets channels, as of the last update()
+	bool overlaid = false; // between overlay() and restore()
+	std::vector<DmxLayerUniverse *> sources; // sorted bottom to top when merged
+};
+
+// One layer's channels in one universe. Channels the layer has not set are
+// 0 in values and in mask.
+struct DmxLayerUniverse {
+	alignas(16) uint8_t values[DMX_UNIVERSE_SIZE] = {};
+	alignas(16) uint8_t mask[DMX_UNIVERSE_SIZE] = {}; // 0xFF where the layer sets the channel
+	uint16_t port_address = 0;
+	uint16_t extent = 0; // one past the last channel set
+	uint64_t written = 0; // stack write count at the last change; orders LTP layers of equal priority
+	DmxMergeLayer *layer = nullptr;
+	DmxLayerTarget *target = nullptr;
+};
+
+// A sparse set of channels written by one source (effects, an override, a
+// blackout). Layers are stacked by priority, lowest first; among layers of
+// equal priority the one written last goes on top, so LTP layers behave as
+// latest-takes-precedence. Game thread only.
+class DmxMergeLayer {
+	friend class DmxLayerStack;
+
+	DmxLayerStack *stack = nullptr; // null once removed from the stack
+	DmxUniverseArena<DmxLayerUniverse> universes;
+	std::vector<DmxLayerUniverse *> universe_list;
+	int priority = 0;
+	DmxLayerMode mode = DMX_LAYER_HTP;
+	uint32_t opacity = 256; // 0-256
+	bool enabled = true;
+
+	DmxLayerUniverse *get_universe(uint16_t port_address, uint16_t channel, size_t count);
+	void touch(DmxLayerUniverse &universe);
+	void touch_all();
+
+public:
+	bool is_attached() const { return stack != nullptr; }
+
+	bool set_channels(uint16_t port_address, uint16_t channel, const uint8_t *values, size_t count);
+	bool fill_channels(uint16_t port_address, uint16_t channel, size_t count, uint8_t value);
+	// Hands the channels back to the layers below.
+	bool clear_channels(uint16_t port_address, uint16_t channel, size_t count);
+	void clear();
+	// Returns -1 for channels the layer does not set.
+	int get_channel(uint16_t port_address, uint16_t channel) const;
+
+	void set_priority(int p_priority);
+	int get_priority() const { return priority; }
+	void set_mode(DmxLayerMode p_mode);
+	DmxLayerMode get_mode() const { return mode; }
+	// HTP layers scale their values by opacity; LTP layers crossfade from the
+	// layers below to their values.
+	void set_opacity(double p_opacity);
+	double get_opacity() const { return opacity / 256.0; }
+	void set_enabled(bool enable);
+	bool is_enabled() const { return enabled; }
+};
+
+// Merges layers into an output's universes. The output's own slab is the
+// bottom of every merge, so layers add to what is written to a universe
+// directly instead of replacing it.
+class DmxLayerStack {
+	friend class DmxMergeLayer;
+
+	std::vector<std::shared_ptr<DmxMergeLayer>> layers;
+	DmxUniverseArena<DmxLayerTarget> targets;
+	std::vector<DmxLayerTarget *> dirty;
+	std::vector<std::pair<DmxLayerTarget *, DmxUniverseBuffer *>> overlaid;
+	uint64_t write_count = 0;
+	alignas(16) uint8_t scratch[DMX_UNIVERSE_SIZE] = {};
+	alignas(16) uint8_t zeros[DMX_UNIVERSE_SIZE] = {};
+
+	DmxLayerTarget *get_target(uint16_t port_address);
+	void mark_dirty(DmxLayerTarget &target);
+	void merge(const DmxLayerTarget &target, const uint8_t *base, uint16_t base_length, uint8_t *out, uint16_t &r_length);
+
+public:
+	~DmxLayerStack();
+
+	std::shared_ptr<DmxMergeLayer> create_layer(int priority, DmxLayerMode mode);
+	// The layer's channels go back to the layers below on the next update().
+	// Returns false if the layer is not part of this stack.
+	bool remove_layer(DmxMergeLayer *layer);
+	void clear();
+	size_t get_layer_count() const { return layers.size(); }
+	// As of the last update(). A universe whose layers were all removed,
+	// cleared or disabled is no longer layered and is sent as written.
+	bool is_layered(uint16_t port_address) const {
+		const DmxLayerTarget *target = targets.find(port_address);
+		return target && target->active;
+	}
+
+	// Re-sorts the layers of every universe whose layers changed. Returns
+	// the number of universes updated.
+	size_t update();
+	// Brings the layers up to date and merges them over the slabs of the
+	// layered universes in list; other universes are left alone. restore()
+	// puts the slabs back as they were written. The output wraps every send
+	// in the two, so no write path can send a layered universe unmerged.
+	void overlay(DmxUniverseBuffer *const *list, size_t count);
+	void restore();
+};
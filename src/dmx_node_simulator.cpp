@@ -0,0 +1,191 @@
+#include "dmx_node_simulator.h"
+
+#include <cstring>
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/main_loop.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+
+void DmxNodeSimulator::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("start", "universes", "bind_address", "port"), &DmxNodeSimulator::start, DEFVAL("127.0.0.1"), DEFVAL(ARTNET_DEFAULT_PORT));
+	ClassDB::bind_method(D_METHOD("stop"), &DmxNodeSimulator::stop);
+	ClassDB::bind_method(D_METHOD("is_running"), &DmxNodeSimulator::is_running);
+	ClassDB::bind_method(D_METHOD("set_latency_stamp_channel", "channel"), &DmxNodeSimulator::set_latency_stamp_channel);
+	ClassDB::bind_method(D_METHOD("get_latency_stamp_channel"), &DmxNodeSimulator::get_latency_stamp_channel);
+	ClassDB::bind_method(D_METHOD("make_latency_stamp"), &DmxNodeSimulator::make_latency_stamp);
+	ClassDB::bind_method(D_METHOD("poll"), &DmxNodeSimulator::poll);
+	ClassDB::bind_method(D_METHOD("get_universes"), &DmxNodeSimulator::get_universes);
+	ClassDB::bind_method(D_METHOD("get_universe_data", "universe"), &DmxNodeSimulator::get_universe_data);
+	ClassDB::bind_method(D_METHOD("get_universe_stats", "universe"), &DmxNodeSimulator::get_universe_stats);
+	ClassDB::bind_method(D_METHOD("get_stats"), &DmxNodeSimulator::get_stats);
+	ClassDB::bind_method(D_METHOD("reset_stats"), &DmxNodeSimulator::reset_stats);
+	ClassDB::bind_method(D_METHOD("get_image"), &DmxNodeSimulator::get_image);
+	ClassDB::bind_method(D_METHOD("get_texture"), &DmxNodeSimulator::get_texture);
+}
+
+DmxNodeSimulator::~DmxNodeSimulator() {
+	stop();
+}
+
+bool DmxNodeSimulator::start(const PackedInt32Array &universes, const String &bind_address, int port) {
+	ArtNetAddress bind;
+	if (simulator.is_running() || universes.is_empty() || port < 0 || port > UINT16_MAX || !ArtNetAddress::parse(bind_address.utf8().get_data(), static_cast<uint16_t>(port), bind)) {
+		return false;
+	}
+	simulator.clear();
+	for (int64_t i = 0; i < universes.size(); i++) {
+		if (universes[i] < 0 || universes[i] > ARTNET_MAX_PORT_ADDRESS || !simulator.listen(static_cast<uint16_t>(universes[i]))) {
+			simulator.clear();
+			return false;
+		}
+	}
+	if (!simulator.start(bind)) {
+		return false;
+	}
+
+	image = Image::create(DMX_UNIVERSE_SIZE, static_cast<int32_t>(simulator.get_universes().size()), false, Image::FORMAT_L8);
+	if (texture.is_valid()) {
+		texture->set_image(image);
+	}
+
+	// Like ArtNetController::start_receiving(), pick up frames once per frame.
+	MainLoop *main_loop = Engine::get_singleton()->get_main_loop();
+	if (main_loop && main_loop->has_signal("process_frame")) {
+		main_loop->connect("process_frame", callable_mp(this, &DmxNodeSimulator::poll));
+	}
+	return true;
+}
+
+void DmxNodeSimulator::stop() {
+	if (!simulator.is_running()) {
+		return;
+	}
+	MainLoop *main_loop = Engine::get_singleton()->get_main_loop();
+	Callable callable = callable_mp(this, &DmxNodeSimulator::poll);
+	if (main_loop && main_loop->is_connected("process_frame", callable)) {
+		main_loop->disconnect("process_frame", callable);
+	}
+	simulator.stop();
+}
+
+bool DmxNodeSimulator::is_running() const {
+	return simulator.is_running();
+}
+
+bool DmxNodeSimulator::set_latency_stamp_channel(int channel) {
+	return simulator.set_latency_stamp_channel(channel);
+}
+
+int DmxNodeSimulator::get_latency_stamp_channel() const {
+	return simulator.get_latency_stamp_channel();
+}
+
+PackedByteArray DmxNodeSimulator::make_latency_stamp() const {
+	PackedByteArray stamp;
+	stamp.resize(ARTNET_LATENCY_STAMP_SIZE);
+	ArtNetNodeSimulator::write_latency_stamp(stamp.ptrw(), ArtNetNodeSimulator::get_clock_usec());
+	return stamp;
+}
+
+int DmxNodeSimulator::poll() {
+	if (!simulator.take_pending()) {
+		return 0;
+	}
+	const std::vector<DmxSimulatedUniverse *> &universes = simulator.get_universes();
+	uint8_t *pixels = image.is_valid() ? image->ptrw() : nullptr;
+	int updated = 0;
+	for (size_t row = 0; row < universes.size(); row++) {
+		DmxSimulatedUniverse &universe = *universes[row];
+		if (!universe.index.acquire()) {
+			continue;
+		}
+		updated++;
+		if (pixels) {
+			std::memcpy(pixels + row * DMX_UNIVERSE_SIZE, universe.frames[universe.index.front()], DMX_UNIVERSE_SIZE);
+		}
+	}
+	if (updated > 0 && texture.is_valid()) {
+		texture->update(image);
+	}
+	return updated;
+}
+
+PackedInt32Array DmxNodeSimulator::get_universes() const {
+	PackedInt32Array result;
+	for (const DmxSimulatedUniverse *universe : simulator.get_universes()) {
+		result.push_back(universe->port_address);
+	}
+	return result;
+}
+
+PackedByteArray DmxNodeSimulator::get_universe_data(int universe) const {
+	PackedByteArray data;
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
+		return data;
+	}
+	const DmxSimulatedUniverse *buffer = simulator.find_universe(static_cast<uint16_t>(universe));
+	if (!buffer) {
+		return data;
+	}
+	uint8_t front = buffer->index.front();
+	data.resize(buffer->frame_length[front]);
+	if (buffer->frame_length[front] > 0) {
+		std::memcpy(data.ptrw(), buffer->frames[front], buffer->frame_length[front]);
+	}
+	return data;
+}
+
+Dictionary DmxNodeSimulator::get_universe_stats(int universe) const {
+	Dictionary stats;
+	if (universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS) {
+		return stats;
+	}
+	const DmxSimulatedUniverse *buffer = simulator.find_universe(static_cast<uint16_t>(universe));
+	if (!buffer) {
+		return stats;
+	}
+	DmxSimulatedUniverseStats values;
+	ArtNetNodeSimulator::read_stats(*buffer, values);
+	stats["packets"] = static_cast<int64_t>(values.packets);
+	stats["lost"] = static_cast<int64_t>(values.lost);
+	stats["out_of_order"] = static_cast<int64_t>(values.out_of_order);
+	stats["duplicates"] = static_cast<int64_t>(values.duplicates);
+	stats["rate"] = values.rate_hz;
+	stats["latency_avg_usec"] = values.latency_avg_usec;
+	stats["latency_max_usec"] = values.latency_max_usec;
+	stats["length"] = buffer->frame_length[buffer->index.front()];
+	return stats;
+}
+
+Dictionary DmxNodeSimulator::get_stats() const {
+	Dictionary stats;
+	stats["packets_received"] = static_cast<int64_t>(simulator.get_packets_received());
+	stats["packets_ignored"] = static_cast<int64_t>(simulator.get_packets_ignored());
+	stats["syncs_received"] = static_cast<int64_t>(simulator.get_syncs_received());
+	uint64_t lost = 0;
+	uint64_t out_of_order = 0;
+	for (const DmxSimulatedUniverse *universe : simulator.get_universes()) {
+		lost += universe->lost.load(std::memory_order_relaxed);
+		out_of_order += universe->out_of_order.load(std::memory_order_relaxed);
+	}
+	stats["lost"] = static_cast<int64_t>(lost);
+	stats["out_of_order"] = static_cast<int64_t>(out_of_order);
+	return stats;
+}
+
+void DmxNodeSimulator::reset_stats() {
+	simulator.reset_stats();
+}
+
+Ref<Image> DmxNodeSimulator::get_image() {
+	return image;
+}
+
+Ref<ImageTexture> DmxNodeSimulator::get_texture() {
+	if (texture.is_null() && image.is_valid()) {
+		texture = ImageTexture::create_from_image(image);
+	}
+	return texture;
+}
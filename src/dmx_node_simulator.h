@@ -0,0 +1,51 @@
+#pragma once
+
+#include "godot_cpp/classes/image.hpp"
+#include "godot_cpp/classes/image_texture.hpp"
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include "godot_cpp/variant/packed_byte_array.hpp"
+#include "godot_cpp/variant/packed_int32_array.hpp"
+#include "godot_cpp/variant/string.hpp"
+
+#include "artnet_node_simulator.h"
+
+using namespace godot;
+
+// A local stand-in Art-Net node for testing a show without hardware. It
+// receives on its own socket, keeps per-universe statistics and exposes the
+// received universes as an image, one row of 512 channels per universe.
+class DmxNodeSimulator : public RefCounted {
+	GDCLASS(DmxNodeSimulator, RefCounted)
+
+protected:
+	static void _bind_methods();
+
+private:
+	ArtNetNodeSimulator simulator;
+	Ref<Image> image;
+	Ref<ImageTexture> texture; // created on first use, then updated in place
+
+public:
+	~DmxNodeSimulator();
+
+	bool start(const PackedInt32Array &universes, const String &bind_address = "127.0.0.1", int port = ARTNET_DEFAULT_PORT);
+	void stop();
+	bool is_running() const;
+
+	bool set_latency_stamp_channel(int channel);
+	int get_latency_stamp_channel() const;
+	PackedByteArray make_latency_stamp() const;
+
+	int poll();
+
+	PackedInt32Array get_universes() const;
+	PackedByteArray get_universe_data(int universe) const;
+	Dictionary get_universe_stats(int universe) const;
+	Dictionary get_stats() const;
+	void reset_stats();
+
+	Ref<Image> get_image();
+	Ref<ImageTexture> get_texture();
+};
@@ -0,0 +1,201 @@
+#include "dmx_pack.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "artnet_protocol.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DMX_PACK_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DMX_PACK_NEON
+#endif
+
+namespace {
+
+struct LayoutInfo {
+	uint8_t components;
+	uint8_t bytes_per_component;
+	uint8_t order[4]; // input component (R=0, G=1, B=2, W=3) for each output slot
+};
+
+const LayoutInfo LAYOUTS[DMX_LAYOUT_MAX] = {
+	{ 3, 1, { 0, 1, 2, 0 } }, // RGB
+	{ 3, 1, { 1, 0, 2, 0 } }, // GRB
+	{ 3, 1, { 2, 1, 0, 0 } }, // BGR
+	{ 4, 1, { 0, 1, 2, 3 } }, // RGBW
+	{ 3, 2, { 0, 1, 2, 0 } }, // RGB16
+	{ 4, 2, { 0, 1, 2, 3 } }, // RGBW16
+	{ 1, 1, { 0, 0, 0, 0 } }, // DIMMER
+};
+
+constexpr float LUT_SCALE = static_cast<float>((DmxColorCurve::LUT_SIZE - 1) * 256);
+
+size_t fixtures_that_fit(const DmxPackLayout &layout, size_t count) {
+	size_t footprint = dmx_layout_footprint(layout.layout);
+	size_t stride = std::max(layout.stride, footprint);
+	if (layout.start_channel + footprint > DMX_UNIVERSE_SIZE) {
+		return 0;
+	}
+	return std::min(count, (DMX_UNIVERSE_SIZE - layout.start_channel - footprint) / stride + 1);
+}
+
+// Runs the staged components (already in channel order) through the curve
+// and writes them out fixture by fixture.
+void write_fixtures(uint8_t *dst, const float *staged, size_t fixtures, const DmxPackLayout &layout, const DmxColorCurve &curve) {
+	const LayoutInfo &info = LAYOUTS[layout.layout];
+	size_t stride = std::max(layout.stride, dmx_layout_footprint(layout.layout));
+
+	uint32_t positions[DMX_UNIVERSE_SIZE];
+	dmx_quantize(staged, positions, fixtures * info.components);
+
+	const uint32_t *position = positions;
+	for (size_t f = 0; f < fixtures; f++) {
+		uint8_t *out = dst + layout.start_channel + f * stride;
+		if (info.bytes_per_component == 1) {
+			for (size_t c = 0; c < info.components; c++) {
+				uint16_t level = curve.sample(*position++);
+				out[c] = static_cast<uint8_t>((level * 255u + 32767u) / 65535u);
+			}
+		} else {
+			for (size_t c = 0; c < info.components; c++) {
+				uint16_t level = curve.sample(*position++);
+				out[c * 2] = static_cast<uint8_t>(level >> 8);
+				out[c * 2 + 1] = static_cast<uint8_t>(level & 0xFF);
+			}
+		}
+	}
+}
+
+} // namespace
+
+size_t dmx_layout_components(DmxColorLayout layout) {
+	return LAYOUTS[layout].components;
+}
+
+size_t dmx_layout_footprint(DmxColorLayout layout) {
+	return static_cast<size_t>(LAYOUTS[layout].components) * LAYOUTS[layout].bytes_per_component;
+}
+
+size_t dmx_layout_bytes_per_component(DmxColorLayout layout) {
+	return LAYOUTS[layout].bytes_per_component;
+}
+
+const uint8_t *dmx_layout_order(DmxColorLayout layout) {
+	return LAYOUTS[layout].order;
+}
+
+void DmxColorCurve::build_byte_levels(uint16_t *r_levels) const {
+	for (uint32_t i = 0; i < 256; i++) {
+		r_levels[i] = sample(static_cast<uint32_t>((static_cast<uint64_t>(i) * static_cast<uint64_t>(LUT_SCALE) + 127) / 255));
+	}
+}
+
+void DmxColorCurve::set_gamma(float p_gamma) {
+	gamma = std::max(p_gamma, 0.01f);
+	rebuild();
+}
+
+void DmxColorCurve::set_dimmer(float p_dimmer) {
+	dimmer = std::min(std::max(p_dimmer, 0.0f), 1.0f);
+	rebuild();
+}
+
+void DmxColorCurve::rebuild() {
+	for (size_t i = 0; i < LUT_SIZE; i++) {
+		double x = static_cast<double>(i) / static_cast<double>(LUT_SIZE - 1);
+		double y = std::pow(x, static_cast<double>(gamma)) * dimmer;
+		lut[i] = static_cast<uint16_t>(std::lround(y * 65535.0));
+	}
+	lut[LUT_SIZE] = lut[LUT_SIZE - 1];
+}
+
+void dmx_quantize(const float *values, uint32_t *r_positions, size_t count) {
+	size_t i = 0;
+#if defined(DMX_PACK_SSE2)
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(LUT_SCALE);
+	for (; i + 4 <= count; i += 4) {
+		// max() returns its second operand for NaN, so NaN lands on 0.
+		__m128 v = _mm_max_ps(_mm_loadu_ps(values + i), zero);
+		v = _mm_min_ps(v, one);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(r_positions + i), _mm_cvtps_epi32(_mm_mul_ps(v, scale)));
+	}
+#elif defined(DMX_PACK_NEON)
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	for (; i + 4 <= count; i += 4) {
+		float32x4_t v = vld1q_f32(values + i);
+		// Comparisons are false for NaN, which selects 0.
+		v = vbslq_f32(vcgtq_f32(v, zero), v, zero);
+		v = vminq_f32(v, one);
+		vst1q_u32(r_positions + i, vcvtq_u32_f32(vmlaq_n_f32(vdupq_n_f32(0.5f), v, LUT_SCALE)));
+	}
+#endif
+	for (; i < count; i++) {
+		float v = values[i];
+		v = v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f;
+		r_positions[i] = static_cast<uint32_t>(v * LUT_SCALE + 0.5f);
+	}
+}
+
+size_t dmx_pack_colors(uint8_t *dst, const float *rgba, size_t count, const DmxPackLayout &layout, const DmxColorCurve &curve) {
+	if (layout.layout < 0 || layout.layout >= DMX_LAYOUT_MAX) {
+		return 0;
+	}
+	size_t fixtures = fixtures_that_fit(layout, count);
+	const LayoutInfo &info = LAYOUTS[layout.layout];
+
+	float staged[DMX_UNIVERSE_SIZE];
+	float *out = staged;
+	for (size_t f = 0; f < fixtures; f++) {
+		const float *color = rgba + f * 4;
+		float components[4] = { color[0], color[1], color[2], 0.0f };
+		if (info.components == 4) {
+			float white = std::min(std::min(components[0], components[1]), components[2]);
+			if (white > 0.0f) {
+				components[0] -= white;
+				components[1] -= white;
+				components[2] -= white;
+				components[3] = white;
+			}
+		} else if (info.components == 1) {
+			components[0] = std::max(std::max(components[0], components[1]), components[2]);
+		}
+		for (size_t c = 0; c < info.components; c++) {
+			*out++ = components[info.order[c]];
+		}
+	}
+	write_fixtures(dst, staged, fixtures, layout, curve);
+	return fixtures;
+}
+
+size_t dmx_pack_values(uint8_t *dst, const float *values, size_t count, const DmxPackLayout &layout, const DmxColorCurve &curve) {
+	if (layout.layout < 0 || layout.layout >= DMX_LAYOUT_MAX) {
+		return 0;
+	}
+	size_t fixtures = fixtures_that_fit(layout, count);
+	const LayoutInfo &info = LAYOUTS[layout.layout];
+
+	float staged[DMX_UNIVERSE_SIZE];
+	float *out = staged;
+	for (size_t f = 0; f < fixtures; f++) {
+		const float *components = values + f * info.components;
+		for (size_t c = 0; c < info.components; c++) {
+			*out++ = components[info.order[c]];
+		}
+	}
+	write_fixtures(dst, staged, fixtures, layout, curve);
+	return fixtures;
+}
+
+size_t dmx_pack_end(const DmxPackLayout &layout, size_t count) {
+	if (count == 0) {
+		return 0;
+	}
+	size_t footprint = dmx_layout_footprint(layout.layout);
+	return layout.start_channel + (count - 1) * std::max(layout.stride, footprint) + footprint;
+}
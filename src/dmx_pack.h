@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Fixture channel layouts understood by the packing kernel. 16-bit layouts
+// send each component as a coarse/fine channel pair.
+enum DmxColorLayout {
+	DMX_LAYOUT_RGB,
+	DMX_LAYOUT_GRB,
+	DMX_LAYOUT_BGR,
+	DMX_LAYOUT_RGBW,
+	DMX_LAYOUT_RGB16,
+	DMX_LAYOUT_RGBW16,
+	DMX_LAYOUT_DIMMER,
+	DMX_LAYOUT_MAX,
+};
+
+struct DmxPackLayout {
+	DmxColorLayout layout = DMX_LAYOUT_RGB;
+	size_t start_channel = 0; // 0-based
+	size_t stride = 0; // channels between fixtures; 0 packs fixtures back to back
+};
+
+// Number of input components per fixture (3 for RGB, 4 for RGBW, 1 for dimmer).
+size_t dmx_layout_components(DmxColorLayout layout);
+// Number of DMX channels a single fixture occupies.
+size_t dmx_layout_footprint(DmxColorLayout layout);
+// 1, or 2 for coarse/fine layouts.
+size_t dmx_layout_bytes_per_component(DmxColorLayout layout);
+// Input component (R=0, G=1, B=2, W=3) sent in each of the fixture's component slots.
+const uint8_t *dmx_layout_order(DmxColorLayout layout);
+
+// Gamma and master dimmer curve applied to every packed component, baked
+// into a lookup table that is sampled with linear interpolation.
+class DmxColorCurve {
+public:
+	static constexpr size_t LUT_SIZE = 4096;
+
+private:
+	uint16_t lut[LUT_SIZE + 1]; // extra entry so interpolation never reads past the end
+	float gamma = 1.0f;
+	float dimmer = 1.0f;
+
+	void rebuild();
+
+public:
+	DmxColorCurve() { rebuild(); }
+
+	void set_gamma(float p_gamma);
+	float get_gamma() const { return gamma; }
+	void set_dimmer(float p_dimmer);
+	float get_dimmer() const { return dimmer; }
+
+	// Fills levels[i] with the 16-bit level for the 8-bit input i, for
+	// callers that start from 8-bit pixels instead of floats.
+	void build_byte_levels(uint16_t *r_levels) const;
+
+	// Largest position dmx_quantize produces (an input of 1.0).
+	static constexpr uint32_t POSITION_MAX = (LUT_SIZE - 1) * 256;
+
+	// Maps a fixed-point LUT position to a 16-bit level, bypassing the curve.
+	static uint16_t linear(uint32_t position) {
+		return static_cast<uint16_t>((static_cast<uint64_t>(position) * 65535u + POSITION_MAX / 2) / POSITION_MAX);
+	}
+
+	// Maps a fixed-point LUT position (see dmx_quantize) to a 16-bit level.
+	uint16_t sample(uint32_t position) const {
+		uint32_t index = position >> 8;
+		uint32_t fraction = position & 0xFF;
+		int32_t a = lut[index];
+		int32_t b = lut[index + 1];
+		return static_cast<uint16_t>(a + (((b - a) * static_cast<int32_t>(fraction)) >> 8));
+	}
+};
+
+// Clamps values to 0..1 and converts them to fixed-point LUT positions
+// (8 fractional bits). NaN maps to 0. Vectorized with SSE2 or NEON when available.
+void dmx_quantize(const float *values, uint32_t *r_positions, size_t count);
+
+// Packs Godot Colors (four floats each, RGBA) into dst, a full DMX universe.
+// RGBW layouts extract white as min(r, g, b); the dimmer layout uses the
+// brightest component. Returns the number of fixtures that fit.
+size_t dmx_pack_colors(uint8_t *dst, const float *rgba, size_t count, const DmxPackLayout &layout, const DmxColorCurve &curve);
+
+// Packs raw component values, dmx_layout_components() floats per fixture in
+// R, G, B, W order regardless of the layout's channel order.
+size_t dmx_pack_values(uint8_t *dst, const float *values, size_t count, const DmxPackLayout &layout, const DmxColorCurve &curve);
+
+// One past the last channel written when packing count fixtures.
+size_t dmx_pack_end(const DmxPackLayout &layout, size_t count);
@@ -0,0 +1,266 @@
+#include "dmx_patch.h"
+
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/variant/utility_functions.hpp>
+
+using namespace godot;
+
+namespace {
+
+bool is_number(const Variant &value) {
+	// JSON.parse_string() returns every number as a float.
+	return value.get_type() == Variant::INT || value.get_type() == Variant::FLOAT;
+}
+
+// Reads an optional integer field; false if it is present but not a whole number in range.
+bool read_int(const Dictionary &definition, const char *key, int64_t min, int64_t max, int64_t &r_value) {
+	if (!definition.has(key)) {
+		return true;
+	}
+	Variant value = definition[key];
+	if (!is_number(value)) {
+		return false;
+	}
+	double number = value;
+	if (number != static_cast<double>(static_cast<int64_t>(number)) || number < min || number > max) {
+		return false;
+	}
+	r_value = static_cast<int64_t>(number);
+	return true;
+}
+
+bool read_flag(const Dictionary &definition, const char *key, uint8_t flag, uint8_t &r_flags) {
+	if (!definition.has(key)) {
+		return true;
+	}
+	Variant value = definition[key];
+	if (value.get_type() != Variant::BOOL) {
+		return false;
+	}
+	if (static_cast<bool>(value)) {
+		r_flags |= flag;
+	}
+	return true;
+}
+
+} // namespace
+
+void DmxPatch::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("load", "patch"), &DmxPatch::load);
+	ClassDB::bind_method(D_METHOD("clear"), &DmxPatch::clear);
+	ClassDB::bind_method(D_METHOD("get_fixture_count"), &DmxPatch::get_fixture_count);
+	ClassDB::bind_method(D_METHOD("get_attribute_count"), &DmxPatch::get_attribute_count);
+	ClassDB::bind_method(D_METHOD("get_fixture_attribute_offset", "fixture"), &DmxPatch::get_fixture_attribute_offset);
+	ClassDB::bind_method(D_METHOD("get_attribute_index", "fixture", "attribute"), &DmxPatch::get_attribute_index);
+	ClassDB::bind_method(D_METHOD("get_fixture_attributes", "fixture"), &DmxPatch::get_fixture_attributes);
+	ClassDB::bind_method(D_METHOD("get_universes"), &DmxPatch::get_universes);
+	ClassDB::bind_method(D_METHOD("apply", "controller", "attributes"), &DmxPatch::apply);
+}
+
+bool DmxPatch::parse_profile(const String &name, const Variant &definition) {
+	if (definition.get_type() != Variant::DICTIONARY) {
+		UtilityFunctions::push_error("DmxPatch: profile \"", name, "\" must be a Dictionary.");
+		return false;
+	}
+	Variant channels = Dictionary(definition).get("channels", Variant());
+	if (channels.get_type() != Variant::ARRAY || Array(channels).is_empty()) {
+		UtilityFunctions::push_error("DmxPatch: profile \"", name, "\" needs a non-empty \"channels\" array.");
+		return false;
+	}
+
+	Profile profile;
+	profile.name = name.utf8().get_data();
+	Array list = channels;
+	size_t footprint = 0;
+	for (int64_t i = 0; i < list.size(); i++) {
+		Variant entry = list[i];
+		DmxPatchChannel channel;
+		String attribute;
+		if (entry.get_type() == Variant::STRING || entry.get_type() == Variant::STRING_NAME) {
+			attribute = entry;
+		} else if (entry.get_type() == Variant::DICTIONARY) {
+			Dictionary fields = entry;
+			int64_t value = -1;
+			bool valid = read_int(fields, "value", 0, 255, value) && read_flag(fields, "fine", DmxPatchChannel::FINE, channel.flags) && read_flag(fields, "invert", DmxPatchChannel::INVERT, channel.flags) && read_flag(fields, "curve", DmxPatchChannel::CURVE, channel.flags);
+			if (fields.has("attribute")) {
+				attribute = fields["attribute"];
+			}
+			if (!valid || attribute.is_empty() == (value < 0)) {
+				UtilityFunctions::push_error("DmxPatch: channel ", i, " of profile \"", name, "\" needs either an \"attribute\" or a \"value\" (0-255).");
+				return false;
+			}
+			if (value >= 0) {
+				channel.flags = DmxPatchChannel::CONSTANT;
+				channel.value = static_cast<uint8_t>(value);
+			}
+		} else {
+			UtilityFunctions::push_error("DmxPatch: channel ", i, " of profile \"", name, "\" must be an attribute name or a Dictionary.");
+			return false;
+		}
+
+		if (!(channel.flags & DmxPatchChannel::CONSTANT)) {
+			// A name used on several channels drives all of them from one attribute.
+			int64_t index = profile.attributes.find(attribute);
+			if (index < 0) {
+				index = profile.attributes.size();
+				profile.attributes.push_back(attribute);
+			}
+			channel.attribute = static_cast<uint32_t>(index);
+		}
+		footprint += channel.footprint();
+		profile.channels.push_back(channel);
+	}
+	if (footprint > DMX_UNIVERSE_SIZE) {
+		UtilityFunctions::push_error("DmxPatch: profile \"", name, "\" is larger than a universe.");
+		return false;
+	}
+	profiles.push_back(std::move(profile));
+	return true;
+}
+
+bool DmxPatch::parse_fixture(int64_t index, const Variant &definition) {
+	if (definition.get_type() != Variant::DICTIONARY) {
+		UtilityFunctions::push_error("DmxPatch: fixture ", index, " must be a Dictionary.");
+		return false;
+	}
+	Dictionary fields = definition;
+	String name = fields.get("profile", String());
+	std::string key = name.utf8().get_data();
+	uint32_t profile = 0;
+	while (profile < profiles.size() && profiles[profile].name != key) {
+		profile++;
+	}
+	if (profile == profiles.size()) {
+		UtilityFunctions::push_error("DmxPatch: fixture ", index, " uses unknown profile \"", name, "\".");
+		return false;
+	}
+	int64_t universe = -1;
+	int64_t channel = 0;
+	int64_t count = 1;
+	if (!read_int(fields, "universe", 0, ARTNET_MAX_PORT_ADDRESS, universe) || universe < 0 || !read_int(fields, "channel", 0, DMX_UNIVERSE_SIZE - 1, channel) || !read_int(fields, "count", 1, UINT16_MAX, count)) {
+		UtilityFunctions::push_error("DmxPatch: fixture ", index, " needs a \"universe\" (0-32767) and may set \"channel\" (0-511) and \"count\".");
+		return false;
+	}
+
+	const Profile &definition_profile = profiles[profile];
+	size_t footprint = 0;
+	for (const DmxPatchChannel &entry : definition_profile.channels) {
+		footprint += entry.footprint();
+	}
+	for (int64_t i = 0; i < count; i++) {
+		// Runs of fixtures continue at channel 0 of the next universe when one does not fit.
+		if (i > 0 && channel + footprint > DMX_UNIVERSE_SIZE) {
+			universe++;
+			channel = 0;
+		}
+		uint32_t base = 0;
+		if (universe > ARTNET_MAX_PORT_ADDRESS || !plan.add_fixture(static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), definition_profile.channels, static_cast<uint32_t>(definition_profile.attributes.size()), base)) {
+			UtilityFunctions::push_error("DmxPatch: fixture ", index, " does not fit in universe ", universe, ".");
+			return false;
+		}
+		fixtures.push_back({ profile, base });
+		channel += static_cast<int64_t>(footprint);
+	}
+	return true;
+}
+
+bool DmxPatch::load(const Dictionary &patch) {
+	clear();
+	Variant profile_list = patch.get("profiles", Variant());
+	Variant fixture_list = patch.get("fixtures", Variant());
+	if (profile_list.get_type() != Variant::DICTIONARY || fixture_list.get_type() != Variant::ARRAY) {
+		UtilityFunctions::push_error("DmxPatch: a patch needs a \"profiles\" Dictionary and a \"fixtures\" Array.");
+		return false;
+	}
+
+	Dictionary profile_definitions = profile_list;
+	Array names = profile_definitions.keys();
+	for (int64_t i = 0; i < names.size(); i++) {
+		if (!parse_profile(names[i], profile_definitions[names[i]])) {
+			clear();
+			return false;
+		}
+	}
+	Array fixture_definitions = fixture_list;
+	for (int64_t i = 0; i < fixture_definitions.size(); i++) {
+		if (!parse_fixture(i, fixture_definitions[i])) {
+			clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+void DmxPatch::clear() {
+	plan.clear();
+	profiles.clear();
+	fixtures.clear();
+	bound = false;
+}
+
+int DmxPatch::get_fixture_count() const {
+	return static_cast<int>(fixtures.size());
+}
+
+int DmxPatch::get_attribute_count() const {
+	return static_cast<int>(plan.get_attribute_count());
+}
+
+int DmxPatch::get_fixture_attribute_offset(int fixture) const {
+	if (fixture < 0 || fixture >= static_cast<int>(fixtures.size())) {
+		return -1;
+	}
+	return static_cast<int>(fixtures[fixture].attribute_base);
+}
+
+int DmxPatch::get_attribute_index(int fixture, const String &attribute) const {
+	if (fixture < 0 || fixture >= static_cast<int>(fixtures.size())) {
+		return -1;
+	}
+	int64_t index = profiles[fixtures[fixture].profile].attributes.find(attribute);
+	if (index < 0) {
+		return -1;
+	}
+	return static_cast<int>(fixtures[fixture].attribute_base + index);
+}
+
+PackedStringArray DmxPatch::get_fixture_attributes(int fixture) const {
+	if (fixture < 0 || fixture >= static_cast<int>(fixtures.size())) {
+		return PackedStringArray();
+	}
+	return profiles[fixtures[fixture].profile].attributes;
+}
+
+PackedInt32Array DmxPatch::get_universes() const {
+	PackedInt32Array result;
+	for (uint16_t universe : plan.get_universes()) {
+		result.push_back(universe);
+	}
+	return result;
+}
+
+bool DmxPatch::bind_controller(const Ref<ArtNetController> &controller) {
+	if (bound && bound_controller == controller) {
+		return true;
+	}
+	bound = false;
+	bound_controller = controller;
+	if (!controller->get_output().bind_universes(plan.get_universes(), buffers, slabs)) {
+		return false;
+	}
+	bound = true;
+	return true;
+}
+
+bool DmxPatch::apply(const Ref<ArtNetController> &controller, const PackedFloat32Array &attributes) {
+	if (controller.is_null() || fixtures.empty() || attributes.size() < static_cast<int64_t>(plan.get_attribute_count())) {
+		return false;
+	}
+	if (!bind_controller(controller)) {
+		return false;
+	}
+
+	plan.apply(attributes.ptr(), slabs.data(), controller->get_color_curve());
+	ArtNetOutput::extend_lengths(buffers, plan.get_universe_ends());
+	return true;
+}
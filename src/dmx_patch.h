@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/dictionary.hpp"
+#include "godot_cpp/variant/packed_float32_array.hpp"
+#include "godot_cpp/variant/packed_int32_array.hpp"
+#include "godot_cpp/variant/packed_string_array.hpp"
+
+#include "artnet_controller.h"
+#include "dmx_patch_plan.h"
+
+using namespace godot;
+
+// A declarative patch (fixture profiles plus where each fixture sits)
+// compiled once into a flat write plan. Each frame the game fills one
+// PackedFloat32Array with every fixture's attributes and apply() writes the
+// universes in a single native pass.
+class DmxPatch : public RefCounted {
+	GDCLASS(DmxPatch, RefCounted)
+
+protected:
+	static void _bind_methods();
+
+private:
+	struct Profile {
+		std::string name;
+		std::vector<DmxPatchChannel> channels;
+		PackedStringArray attributes;
+	};
+
+	struct Fixture {
+		uint32_t profile;
+		uint32_t attribute_base;
+	};
+
+	DmxPatchPlan plan;
+	std::vector<Profile> profiles;
+	std::vector<Fixture> fixtures;
+
+	// Universe buffers resolved for the controller used last.
+	Ref<ArtNetController> bound_controller;
+	std::vector<DmxUniverseBuffer *> buffers;
+	std::vector<uint8_t *> slabs;
+	bool bound = false;
+
+	bool parse_profile(const String &name, const Variant &definition);
+	bool parse_fixture(int64_t index, const Variant &definition);
+	bool bind_controller(const Ref<ArtNetController> &controller);
+
+public:
+	bool load(const Dictionary &patch);
+	void clear();
+
+	int get_fixture_count() const;
+	int get_attribute_count() const;
+	int get_fixture_attribute_offset(int fixture) const;
+	int get_attribute_index(int fixture, const String &attribute) const;
+	PackedStringArray get_fixture_attributes(int fixture) const;
+	PackedInt32Array get_universes() const;
+
+	bool apply(const Ref<ArtNetController> &controller, const PackedFloat32Array &attributes);
+};
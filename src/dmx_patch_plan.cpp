@@ -0,0 +1,91 @@
+#include "dmx_patch_plan.h"
+
+#include <algorithm>
+
+#include "artnet_protocol.h"
+
+size_t DmxPatchPlan::universe_slot(uint16_t port_address) {
+	for (size_t i = 0; i < universes.size(); i++) {
+		if (universes[i] == port_address) {
+			return i;
+		}
+	}
+	universes.push_back(port_address);
+	universe_end.push_back(0);
+	return universes.size() - 1;
+}
+
+void DmxPatchPlan::clear() {
+	writes.clear();
+	sorted = true;
+	attribute_count = 0;
+	fixture_count = 0;
+	universes.clear();
+	universe_end.clear();
+	positions.clear();
+}
+
+bool DmxPatchPlan::add_fixture(uint16_t port_address, uint16_t channel, const std::vector<DmxPatchChannel> &profile, uint32_t profile_attributes, uint32_t &r_attribute_base) {
+	size_t footprint = 0;
+	for (const DmxPatchChannel &entry : profile) {
+		if (!(entry.flags & DmxPatchChannel::CONSTANT) && entry.attribute >= profile_attributes) {
+			return false;
+		}
+		footprint += entry.footprint();
+	}
+	if (footprint == 0 || port_address > ARTNET_MAX_PORT_ADDRESS || channel + footprint > DMX_UNIVERSE_SIZE) {
+		return false;
+	}
+
+	size_t slot = universe_slot(port_address);
+	uint32_t base = static_cast<uint32_t>(attribute_count);
+	uint32_t target = static_cast<uint32_t>(slot * DMX_UNIVERSE_SIZE + channel);
+	for (const DmxPatchChannel &entry : profile) {
+		Write write;
+		write.target = target;
+		write.attribute = (entry.flags & DmxPatchChannel::CONSTANT) ? 0 : base + entry.attribute;
+		write.flags = entry.flags;
+		write.value = entry.value;
+		if (!writes.empty() && writes.back().target > target) {
+			sorted = false;
+		}
+		writes.push_back(write);
+		target += static_cast<uint32_t>(entry.footprint());
+	}
+	universe_end[slot] = std::max(universe_end[slot], static_cast<uint16_t>(channel + footprint));
+	attribute_count += profile_attributes;
+	fixture_count++;
+	r_attribute_base = base;
+	return true;
+}
+
+void DmxPatchPlan::apply(const float *attributes, uint8_t *const *universe_data, const DmxColorCurve &curve) {
+	if (!sorted) {
+		// Walk the slabs in order; stable, so later fixtures still win overlaps.
+		std::stable_sort(writes.begin(), writes.end(), [](const Write &a, const Write &b) {
+			return a.target < b.target;
+		});
+		sorted = true;
+	}
+	positions.resize(attribute_count);
+	dmx_quantize(attributes, positions.data(), attribute_count);
+
+	for (const Write &write : writes) {
+		uint8_t *out = universe_data[write.target / DMX_UNIVERSE_SIZE] + write.target % DMX_UNIVERSE_SIZE;
+		if (write.flags & DmxPatchChannel::CONSTANT) {
+			*out = write.value;
+			continue;
+		}
+		uint32_t position = positions[write.attribute];
+		uint16_t level = (write.flags & DmxPatchChannel::CURVE) ? curve.sample(position) : DmxColorCurve::linear(position);
+		if (write.flags & DmxPatchChannel::INVERT) {
+			level = static_cast<uint16_t>(65535 - level);
+		}
+		if (write.flags & DmxPatchChannel::FINE) {
+			out[0] = static_cast<uint8_t>(level >> 8);
+			out[1] = static_cast<uint8_t>(level & 0xFF);
+		} else {
+			out[0] = static_cast<uint8_t>((level * 255u + 32767u) / 65535u);
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "dmx_pack.h"
+
+// One channel of a fixture profile.
+struct DmxPatchChannel {
+	enum Flags : uint8_t {
+		FINE = 1 << 0, // coarse/fine pair, two channels
+		INVERT = 1 << 1, // 1.0 sends 0
+		CURVE = 1 << 2, // through the controller's color curve (gamma, master dimmer)
+		CONSTANT = 1 << 3, // always sends value; attribute is unused
+	};
+
+	uint32_t attribute = 0; // index into the fixture's attributes
+	uint8_t flags = 0;
+	uint8_t value = 0;
+
+	size_t footprint() const { return (flags & FINE) ? 2 : 1; }
+};
+
+// A patch compiled into a flat write plan. Each fixture's profile is
+// expanded into one entry per channel (attribute index, absolute slab
+// offset, conversion), sorted by offset, so applying a frame of attribute
+// values is a single pass with no per-fixture bookkeeping.
+class DmxPatchPlan {
+	struct Write {
+		uint32_t target; // universe slot * DMX_UNIVERSE_SIZE + channel
+		uint32_t attribute;
+		uint8_t flags;
+		uint8_t value;
+	};
+
+	std::vector<Write> writes;
+	bool sorted = true;
+	size_t attribute_count = 0;
+	size_t fixture_count = 0;
+
+	// Port-Addresses the plan writes, indexed by universe slot, and one past
+	// the last channel written in each.
+	std::vector<uint16_t> universes;
+	std::vector<uint16_t> universe_end;
+
+	std::vector<uint32_t> positions; // staging for the quantized attributes
+
+	size_t universe_slot(uint16_t port_address);
+
+public:
+	void clear();
+
+	// Appends a fixture whose first channel is channel and whose attributes
+	// start at the next free attribute index, which is returned in
+	// r_attribute_base. Returns false if the profile is empty or does not fit
+	// in the universe. Overlapping fixtures are allowed; where single channels
+	// collide, the fixture added last wins.
+	bool add_fixture(uint16_t port_address, uint16_t channel, const std::vector<DmxPatchChannel> &profile, uint32_t profile_attributes, uint32_t &r_attribute_base);
+
+	size_t get_fixture_count() const { return fixture_count; }
+	size_t get_attribute_count() const { return attribute_count; }
+	size_t get_write_count() const { return writes.size(); }
+	const std::vector<uint16_t> &get_universes() const { return universes; }
+	const std::vector<uint16_t> &get_universe_ends() const { return universe_end; }
+
+	// attributes holds get_attribute_count() values in 0..1.
+	// universe_data[slot] is the slab for get_universes()[slot].
+	void apply(const float *attributes, uint8_t *const *universe_data, const DmxColorCurve &curve);
+};
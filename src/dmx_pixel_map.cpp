@@ -0,0 +1,234 @@
+#include "dmx_pixel_map.h"
+
+#include <algorithm>
+
+#include "artnet_protocol.h"
+
+namespace {
+
+struct GatherContext {
+	const uint8_t *pixels;
+	uint32_t pitch; // bytes per source row
+	uint32_t pixel_size;
+	uint32_t box_width;
+	uint32_t box_height;
+	const uint32_t *source_offset;
+	const uint32_t *target;
+	uint8_t *const *universe_data;
+	const uint8_t *byte_levels; // 8-bit output for each 8-bit input
+	const uint16_t *levels; // 16-bit output for each 8-bit input
+};
+
+template <bool AREA>
+inline void sample(const GatherContext &context, uint32_t offset, uint32_t r_rgb[3]) {
+	const uint8_t *pixel = context.pixels + offset;
+	if (!AREA) {
+		r_rgb[0] = pixel[0];
+		r_rgb[1] = pixel[1];
+		r_rgb[2] = pixel[2];
+		return;
+	}
+	uint32_t r = 0;
+	uint32_t g = 0;
+	uint32_t b = 0;
+	for (uint32_t y = 0; y < context.box_height; y++) {
+		const uint8_t *row = pixel + y * context.pitch;
+		for (uint32_t x = 0; x < context.box_width; x++) {
+			r += row[0];
+			g += row[1];
+			b += row[2];
+			row += context.pixel_size;
+		}
+	}
+	uint32_t area = context.box_width * context.box_height;
+	r_rgb[0] = (r + area / 2) / area;
+	r_rgb[1] = (g + area / 2) / area;
+	r_rgb[2] = (b + area / 2) / area;
+}
+
+// One run of fixtures sharing a layout. COMPONENTS and BYTES are template
+// parameters so the inner loop has no per-fixture branches on the layout.
+template <bool AREA, uint32_t COMPONENTS, uint32_t BYTES>
+void gather_run(const GatherContext &context, const uint8_t *order, uint32_t begin, uint32_t end) {
+	for (uint32_t i = begin; i < end; i++) {
+		uint32_t rgb[3];
+		sample<AREA>(context, context.source_offset[i], rgb);
+
+		uint32_t components[4] = { rgb[0], rgb[1], rgb[2], 0 };
+		if (COMPONENTS == 4) {
+			uint32_t white = std::min(std::min(rgb[0], rgb[1]), rgb[2]);
+			components[0] -= white;
+			components[1] -= white;
+			components[2] -= white;
+			components[3] = white;
+		} else if (COMPONENTS == 1) {
+			components[0] = std::max(std::max(rgb[0], rgb[1]), rgb[2]);
+		}
+
+		uint32_t slot = context.target[i] / DMX_UNIVERSE_SIZE;
+		uint8_t *out = context.universe_data[slot] + context.target[i] % DMX_UNIVERSE_SIZE;
+		for (uint32_t c = 0; c < COMPONENTS; c++) {
+			uint32_t value = components[order[c]];
+			if (BYTES == 1) {
+				out[c] = context.byte_levels[value];
+			} else {
+				uint16_t level = context.levels[value];
+				out[c * 2] = static_cast<uint8_t>(level >> 8);
+				out[c * 2 + 1] = static_cast<uint8_t>(level & 0xFF);
+			}
+		}
+	}
+}
+
+template <bool AREA>
+void gather(const GatherContext &context, DmxColorLayout layout, uint32_t begin, uint32_t end) {
+	const uint8_t *order = dmx_layout_order(layout);
+	size_t components = dmx_layout_components(layout);
+	if (dmx_layout_bytes_per_component(layout) == 2) {
+		if (components == 4) {
+			gather_run<AREA, 4, 2>(context, order, begin, end);
+		} else {
+			gather_run<AREA, 3, 2>(context, order, begin, end);
+		}
+	} else if (components == 4) {
+		gather_run<AREA, 4, 1>(context, order, begin, end);
+	} else if (components == 3) {
+		gather_run<AREA, 3, 1>(context, order, begin, end);
+	} else {
+		gather_run<AREA, 1, 1>(context, order, begin, end);
+	}
+}
+
+} // namespace
+
+void DmxPixelMap::clear() {
+	pixel_x.clear();
+	pixel_y.clear();
+	target.clear();
+	runs.clear();
+	universes.clear();
+	universe_end.clear();
+	source_offset.clear();
+	compiled = false;
+}
+
+void DmxPixelMap::set_map_size(uint32_t width, uint32_t height) {
+	map_width = width;
+	map_height = height;
+	compiled = false;
+}
+
+void DmxPixelMap::set_sample_mode(SampleMode mode) {
+	sample_mode = mode;
+	compiled = false;
+}
+
+size_t DmxPixelMap::universe_slot(uint16_t port_address) {
+	// Fixtures are usually added universe by universe, so check the newest slot first.
+	if (!universes.empty() && universes.back() == port_address) {
+		return universes.size() - 1;
+	}
+	auto it = std::find(universes.begin(), universes.end(), port_address);
+	if (it != universes.end()) {
+		return static_cast<size_t>(it - universes.begin());
+	}
+	universes.push_back(port_address);
+	universe_end.push_back(0);
+	return universes.size() - 1;
+}
+
+bool DmxPixelMap::add_fixture(uint16_t x, uint16_t y, uint16_t port_address, uint16_t channel, DmxColorLayout layout) {
+	if (layout < 0 || layout >= DMX_LAYOUT_MAX || port_address > ARTNET_MAX_PORT_ADDRESS) {
+		return false;
+	}
+	size_t end = static_cast<size_t>(channel) + dmx_layout_footprint(layout);
+	if (end > DMX_UNIVERSE_SIZE) {
+		return false;
+	}
+	size_t slot = universe_slot(port_address);
+	universe_end[slot] = std::max(universe_end[slot], static_cast<uint16_t>(end));
+
+	uint32_t index = static_cast<uint32_t>(target.size());
+	pixel_x.push_back(x);
+	pixel_y.push_back(y);
+	target.push_back(static_cast<uint32_t>(slot * DMX_UNIVERSE_SIZE + channel));
+	if (!runs.empty() && runs.back().layout == layout) {
+		runs.back().end = index + 1;
+	} else {
+		runs.push_back({ layout, index, index + 1 });
+	}
+	compiled = false;
+	return true;
+}
+
+void DmxPixelMap::compile(uint32_t width, uint32_t height, uint32_t pixel_size) {
+	uint32_t space_width = map_width ? map_width : width;
+	uint32_t space_height = map_height ? map_height : height;
+
+	box_width = 1;
+	box_height = 1;
+	if (sample_mode == SAMPLE_AREA) {
+		box_width = std::max(1u, width / space_width);
+		box_height = std::max(1u, height / space_height);
+	}
+
+	source_offset.resize(target.size());
+	for (size_t i = 0; i < target.size(); i++) {
+		uint32_t map_x = std::min<uint32_t>(pixel_x[i], space_width - 1);
+		uint32_t map_y = std::min<uint32_t>(pixel_y[i], space_height - 1);
+		uint32_t x;
+		uint32_t y;
+		if (sample_mode == SAMPLE_AREA) {
+			// Top-left of the source area covered by this map pixel.
+			x = std::min(static_cast<uint32_t>(static_cast<uint64_t>(map_x) * width / space_width), width - box_width);
+			y = std::min(static_cast<uint32_t>(static_cast<uint64_t>(map_y) * height / space_height), height - box_height);
+		} else {
+			// Centre of the source area covered by this map pixel.
+			x = static_cast<uint32_t>((static_cast<uint64_t>(map_x) * 2 + 1) * width / (space_width * 2ull));
+			y = static_cast<uint32_t>((static_cast<uint64_t>(map_y) * 2 + 1) * height / (space_height * 2ull));
+		}
+		source_offset[i] = (y * width + x) * pixel_size;
+	}
+
+	compiled_width = width;
+	compiled_height = height;
+	compiled_pixel_size = pixel_size;
+	compiled = true;
+}
+
+void DmxPixelMap::apply(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pixel_size, uint8_t *const *universe_data, const DmxColorCurve &curve) {
+	if (target.empty() || width == 0 || height == 0 || (pixel_size != 3 && pixel_size != 4)) {
+		return;
+	}
+	if (!compiled || width != compiled_width || height != compiled_height || pixel_size != compiled_pixel_size) {
+		compile(width, height, pixel_size);
+	}
+
+	uint16_t levels[256];
+	uint8_t byte_levels[256];
+	curve.build_byte_levels(levels);
+	for (size_t i = 0; i < 256; i++) {
+		byte_levels[i] = static_cast<uint8_t>((levels[i] * 255u + 32767u) / 65535u);
+	}
+
+	GatherContext context;
+	context.pixels = pixels;
+	context.pitch = width * pixel_size;
+	context.pixel_size = pixel_size;
+	context.box_width = box_width;
+	context.box_height = box_height;
+	context.source_offset = source_offset.data();
+	context.target = target.data();
+	context.universe_data = universe_data;
+	context.byte_levels = byte_levels;
+	context.levels = levels;
+
+	bool area = box_width > 1 || box_height > 1;
+	for (const Run &run : runs) {
+		if (area) {
+			gather<true>(context, run.layout, run.begin, run.end);
+		} else {
+			gather<false>(context, run.layout, run.begin, run.end);
+		}
+	}
+}
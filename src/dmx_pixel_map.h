@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "dmx_pack.h"
+
+// Maps pixels of an 8-bit RGB or RGBA image onto fixture channels. Fixtures
+// are stored as a flat structure-of-arrays table (map position, target
+// channel) grouped into runs of one layout, and the per-pixel source offsets
+// are compiled once per source size. Applying the map is then a single gather
+// pass over the table that writes straight into the universe slabs.
+class DmxPixelMap {
+public:
+	enum SampleMode {
+		SAMPLE_NEAREST, // one source pixel per fixture
+		SAMPLE_AREA, // average of the source area a map pixel covers
+	};
+
+private:
+	struct Run {
+		DmxColorLayout layout;
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	// Fixture table. target is universe slot * DMX_UNIVERSE_SIZE + channel.
+	std::vector<uint16_t> pixel_x;
+	std::vector<uint16_t> pixel_y;
+	std::vector<uint32_t> target;
+	std::vector<Run> runs;
+
+	// Port-Addresses the map writes, indexed by universe slot, and one past
+	// the last channel written in each.
+	std::vector<uint16_t> universes;
+	std::vector<uint16_t> universe_end;
+
+	uint32_t map_width = 0; // 0 means the map is in source pixels
+	uint32_t map_height = 0;
+	SampleMode sample_mode = SAMPLE_NEAREST;
+
+	// Source offsets compiled for the last source geometry.
+	std::vector<uint32_t> source_offset;
+	uint32_t compiled_width = 0;
+	uint32_t compiled_height = 0;
+	uint32_t compiled_pixel_size = 0;
+	uint32_t box_width = 1;
+	uint32_t box_height = 1;
+	bool compiled = false;
+
+	size_t universe_slot(uint16_t port_address);
+	void compile(uint32_t width, uint32_t height, uint32_t pixel_size);
+
+public:
+	void clear();
+
+	// The coordinate space fixtures are placed in. Sources of any size are
+	// scaled onto it; 0 x 0 (the default) uses source pixels directly.
+	void set_map_size(uint32_t width, uint32_t height);
+	uint32_t get_map_width() const { return map_width; }
+	uint32_t get_map_height() const { return map_height; }
+
+	void set_sample_mode(SampleMode mode);
+	SampleMode get_sample_mode() const { return sample_mode; }
+
+	// Returns false if the fixture does not fit in the universe.
+	bool add_fixture(uint16_t x, uint16_t y, uint16_t port_address, uint16_t channel, DmxColorLayout layout);
+
+	size_t get_fixture_count() const { return target.size(); }
+	const std::vector<uint16_t> &get_universes() const { return universes; }
+	const std::vector<uint16_t> &get_universe_ends() const { return universe_end; }
+
+	// pixels holds width * height pixels of pixel_size bytes (3 for RGB8, 4 for
+	// RGBA8), rows packed. universe_data[slot] is the slab for get_universes()[slot].
+	void apply(const uint8_t *pixels, uint32_t width, uint32_t height, uint32_t pixel_size, uint8_t *const *universe_data, const DmxColorCurve &curve);
+};
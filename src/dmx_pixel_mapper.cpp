@@ -0,0 +1,166 @@
+#include "dmx_pixel_mapper.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+
+namespace {
+
+// from + (to - from) * step / span, rounded to the nearest pixel.
+int32_t interpolate(int32_t from, int32_t to, int64_t step, int64_t span) {
+	int64_t delta = (static_cast<int64_t>(to) - from) * step;
+	int64_t offset = (std::llabs(delta) * 2 + span) / (span * 2);
+	return static_cast<int32_t>(from + (delta < 0 ? -offset : offset));
+}
+
+} // namespace
+
+void DmxPixelMapper::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_map_size", "size"), &DmxPixelMapper::set_map_size);
+	ClassDB::bind_method(D_METHOD("get_map_size"), &DmxPixelMapper::get_map_size);
+	ClassDB::bind_method(D_METHOD("set_sample_mode", "mode"), &DmxPixelMapper::set_sample_mode);
+	ClassDB::bind_method(D_METHOD("get_sample_mode"), &DmxPixelMapper::get_sample_mode);
+	ClassDB::bind_method(D_METHOD("add_fixture", "pixel", "universe", "channel", "layout"), &DmxPixelMapper::add_fixture, DEFVAL(ArtNetController::COLOR_LAYOUT_RGB));
+	ClassDB::bind_method(D_METHOD("add_strip", "from", "to", "count", "universe", "start_channel", "layout"), &DmxPixelMapper::add_strip, DEFVAL(0), DEFVAL(ArtNetController::COLOR_LAYOUT_RGB));
+	ClassDB::bind_method(D_METHOD("add_grid", "origin", "size", "universe", "start_channel", "layout", "serpentine"), &DmxPixelMapper::add_grid, DEFVAL(0), DEFVAL(ArtNetController::COLOR_LAYOUT_RGB), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("clear"), &DmxPixelMapper::clear);
+	ClassDB::bind_method(D_METHOD("get_fixture_count"), &DmxPixelMapper::get_fixture_count);
+	ClassDB::bind_method(D_METHOD("get_universes"), &DmxPixelMapper::get_universes);
+	ClassDB::bind_method(D_METHOD("apply", "controller", "image"), &DmxPixelMapper::apply);
+
+	BIND_ENUM_CONSTANT(SAMPLE_NEAREST);
+	BIND_ENUM_CONSTANT(SAMPLE_AREA);
+}
+
+void DmxPixelMapper::set_map_size(const Vector2i &size) {
+	map.set_map_size(static_cast<uint32_t>(std::max(size.x, 0)), static_cast<uint32_t>(std::max(size.y, 0)));
+}
+
+Vector2i DmxPixelMapper::get_map_size() const {
+	return Vector2i(static_cast<int32_t>(map.get_map_width()), static_cast<int32_t>(map.get_map_height()));
+}
+
+void DmxPixelMapper::set_sample_mode(SampleMode mode) {
+	map.set_sample_mode(static_cast<DmxPixelMap::SampleMode>(mode));
+}
+
+DmxPixelMapper::SampleMode DmxPixelMapper::get_sample_mode() const {
+	return static_cast<SampleMode>(map.get_sample_mode());
+}
+
+bool DmxPixelMapper::add_fixture(const Vector2i &pixel, int universe, int channel, ArtNetController::ColorLayout layout) {
+	if (pixel.x < 0 || pixel.y < 0 || pixel.x > UINT16_MAX || pixel.y > UINT16_MAX || universe < 0 || universe > ARTNET_MAX_PORT_ADDRESS || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE)) {
+		return false;
+	}
+	if (static_cast<int>(layout) < 0 || static_cast<int>(layout) >= DMX_LAYOUT_MAX) {
+		return false;
+	}
+	bound = false;
+	return map.add_fixture(static_cast<uint16_t>(pixel.x), static_cast<uint16_t>(pixel.y), static_cast<uint16_t>(universe), static_cast<uint16_t>(channel), static_cast<DmxColorLayout>(layout));
+}
+
+bool DmxPixelMapper::place(const Vector2i &pixel, int &universe, int &channel, DmxColorLayout layout) {
+	int footprint = static_cast<int>(dmx_layout_footprint(layout));
+	if (channel + footprint > static_cast<int>(DMX_UNIVERSE_SIZE)) {
+		universe++;
+		channel = 0;
+	}
+	if (!add_fixture(pixel, universe, channel, static_cast<ArtNetController::ColorLayout>(layout))) {
+		return false;
+	}
+	channel += footprint;
+	return true;
+}
+
+int DmxPixelMapper::add_strip(const Vector2i &from, const Vector2i &to, int count, int universe, int start_channel, ArtNetController::ColorLayout layout) {
+	if (count <= 0 || static_cast<int>(layout) < 0 || static_cast<int>(layout) >= DMX_LAYOUT_MAX) {
+		return 0;
+	}
+	int channel = start_channel;
+	int64_t span = count > 1 ? count - 1 : 1;
+	for (int i = 0; i < count; i++) {
+		Vector2i pixel(interpolate(from.x, to.x, i, span), interpolate(from.y, to.y, i, span));
+		if (!place(pixel, universe, channel, static_cast<DmxColorLayout>(layout))) {
+			return i;
+		}
+	}
+	return count;
+}
+
+int DmxPixelMapper::add_grid(const Vector2i &origin, const Vector2i &size, int universe, int start_channel, ArtNetController::ColorLayout layout, bool serpentine) {
+	if (size.x <= 0 || size.y <= 0 || static_cast<int>(layout) < 0 || static_cast<int>(layout) >= DMX_LAYOUT_MAX) {
+		return 0;
+	}
+	int channel = start_channel;
+	int added = 0;
+	for (int row = 0; row < size.y; row++) {
+		bool reversed = serpentine && (row % 2) == 1;
+		for (int column = 0; column < size.x; column++) {
+			int x = reversed ? size.x - 1 - column : column;
+			if (!place(Vector2i(origin.x + x, origin.y + row), universe, channel, static_cast<DmxColorLayout>(layout))) {
+				return added;
+			}
+			added++;
+		}
+	}
+	return added;
+}
+
+void DmxPixelMapper::clear() {
+	map.clear();
+	bound = false;
+}
+
+int DmxPixelMapper::get_fixture_count() const {
+	return static_cast<int>(map.get_fixture_count());
+}
+
+PackedInt32Array DmxPixelMapper::get_universes() const {
+	PackedInt32Array result;
+	for (uint16_t universe : map.get_universes()) {
+		result.push_back(universe);
+	}
+	return result;
+}
+
+bool DmxPixelMapper::bind_controller(const Ref<ArtNetController> &controller) {
+	if (bound && bound_controller == controller) {
+		return true;
+	}
+	bound = false;
+	bound_controller = controller;
+	if (!controller->get_output().bind_universes(map.get_universes(), buffers, slabs)) {
+		return false;
+	}
+	bound = true;
+	return true;
+}
+
+bool DmxPixelMapper::apply(const Ref<ArtNetController> &controller, const Ref<Image> &image) {
+	if (controller.is_null() || image.is_null() || image->is_empty() || map.get_fixture_count() == 0) {
+		return false;
+	}
+	if (!bind_controller(controller)) {
+		return false;
+	}
+
+	Ref<Image> source = image;
+	Image::Format format = source->get_format();
+	if (format != Image::FORMAT_RGB8 && format != Image::FORMAT_RGBA8) {
+		// Slow path: viewports normally hand out RGB8/RGBA8 already.
+		source = image->duplicate();
+		source->convert(Image::FORMAT_RGBA8);
+		format = source->get_format();
+		if (format != Image::FORMAT_RGBA8) {
+			return false;
+		}
+	}
+	uint32_t pixel_size = format == Image::FORMAT_RGB8 ? 3 : 4;
+
+	map.apply(source->ptr(), static_cast<uint32_t>(source->get_width()), static_cast<uint32_t>(source->get_height()), pixel_size, slabs.data(), controller->get_color_curve());
+	ArtNetOutput::extend_lengths(buffers, map.get_universe_ends());
+	return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "godot_cpp/classes/image.hpp"
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/packed_int32_array.hpp"
+#include "godot_cpp/variant/vector2i.hpp"
+
+#include "artnet_controller.h"
+#include "dmx_pixel_map.h"
+
+using namespace godot;
+
+// Maps an Image (e.g. a SubViewport's rendered frame) onto the universes of
+// an ArtNetController in native code. The fixture map is built once; each
+// frame is then a single gather pass straight into the universe buffers.
+class DmxPixelMapper : public RefCounted {
+	GDCLASS(DmxPixelMapper, RefCounted)
+
+public:
+	enum SampleMode {
+		SAMPLE_NEAREST = DmxPixelMap::SAMPLE_NEAREST,
+		SAMPLE_AREA = DmxPixelMap::SAMPLE_AREA,
+	};
+
+protected:
+	static void _bind_methods();
+
+private:
+	DmxPixelMap map;
+
+	// Universe buffers resolved for the controller used last.
+	Ref<ArtNetController> bound_controller;
+	std::vector<DmxUniverseBuffer *> buffers;
+	std::vector<uint8_t *> slabs;
+	bool bound = false;
+
+	bool bind_controller(const Ref<ArtNetController> &controller);
+	// Adds one fixture at channel, moving on to channel 0 of the next universe
+	// when it does not fit, and advances channel past it.
+	bool place(const Vector2i &pixel, int &universe, int &channel, DmxColorLayout layout);
+
+public:
+	void set_map_size(const Vector2i &size);
+	Vector2i get_map_size() const;
+	void set_sample_mode(SampleMode mode);
+	SampleMode get_sample_mode() const;
+
+	bool add_fixture(const Vector2i &pixel, int universe, int channel, ArtNetController::ColorLayout layout = ArtNetController::COLOR_LAYOUT_RGB);
+	int add_strip(const Vector2i &from, const Vector2i &to, int count, int universe, int start_channel = 0, ArtNetController::ColorLayout layout = ArtNetController::COLOR_LAYOUT_RGB);
+	int add_grid(const Vector2i &origin, const Vector2i &size, int universe, int start_channel = 0, ArtNetController::ColorLayout layout = ArtNetController::COLOR_LAYOUT_RGB, bool serpentine = false);
+	void clear();
+
+	int get_fixture_count() const;
+	PackedInt32Array get_universes() const;
+
+	bool apply(const Ref<ArtNetController> &controller, const Ref<Image> &image);
+};
+
+VARIANT_ENUM_CAST(DmxPixelMapper::SampleMode);
@@ -0,0 +1,117 @@
+#include "dmx_player.h"
+
+#include <cstring>
+
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+
+void DmxPlayer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("open", "path"), &DmxPlayer::open);
+	ClassDB::bind_method(D_METHOD("close"), &DmxPlayer::close);
+	ClassDB::bind_method(D_METHOD("is_open"), &DmxPlayer::is_open);
+	ClassDB::bind_method(D_METHOD("get_duration"), &DmxPlayer::get_duration);
+	ClassDB::bind_method(D_METHOD("get_position"), &DmxPlayer::get_position);
+	ClassDB::bind_method(D_METHOD("set_source", "source"), &DmxPlayer::set_source);
+	ClassDB::bind_method(D_METHOD("get_source"), &DmxPlayer::get_source);
+	ClassDB::bind_method(D_METHOD("play_to", "controller", "position"), &DmxPlayer::play_to);
+
+	BIND_ENUM_CONSTANT(PLAYBACK_ALL);
+	BIND_ENUM_CONSTANT(PLAYBACK_SENT);
+	BIND_ENUM_CONSTANT(PLAYBACK_RECEIVED);
+}
+
+bool DmxPlayer::open(const String &path) {
+	close();
+	String file_path = ProjectSettings::get_singleton()->globalize_path(path);
+	return reader.open(file_path.utf8().get_data());
+}
+
+void DmxPlayer::close() {
+	reader.close();
+	targets.clear();
+	bound_controller.unref();
+}
+
+bool DmxPlayer::is_open() const {
+	return reader.is_open();
+}
+
+double DmxPlayer::get_duration() const {
+	return static_cast<double>(reader.get_duration_usec()) / 1000000.0;
+}
+
+double DmxPlayer::get_position() const {
+	int64_t position = reader.get_position_usec();
+	return position < 0 ? 0.0 : static_cast<double>(position) / 1000000.0;
+}
+
+void DmxPlayer::set_source(PlaybackSource p_source) {
+	source = p_source;
+}
+
+DmxPlayer::PlaybackSource DmxPlayer::get_source() const {
+	return source;
+}
+
+DmxUniverseBuffer *DmxPlayer::resolve(uint16_t universe) {
+	bool received = (universe & DMX_RECORDING_RECEIVED) != 0;
+	if ((received && source == PLAYBACK_SENT) || (!received && source == PLAYBACK_RECEIVED)) {
+		return nullptr;
+	}
+	auto it = targets.find(universe);
+	if (it == targets.end()) {
+		Target target;
+		target.buffer = bound_controller->get_output().get_universe(static_cast<uint16_t>(universe & ~DMX_RECORDING_RECEIVED));
+		it = targets.emplace(universe, target).first;
+	}
+	Target &target = it->second;
+	if (target.buffer && target.pass != pass) {
+		target.pass = pass;
+		touched.push_back(target.buffer);
+	}
+	return target.buffer;
+}
+
+int DmxPlayer::play_to(const Ref<ArtNetController> &controller, double position) {
+	if (!reader.is_open() || controller.is_null()) {
+		return 0;
+	}
+	if (bound_controller != controller) {
+		targets.clear();
+		bound_controller = controller;
+	}
+	pass++;
+	touched.clear();
+
+	int64_t time_usec = static_cast<int64_t>(position * 1000000.0);
+	if (reader.should_seek(time_usec)) {
+		// The keyframe rewrites every recorded universe; start from blackout so
+		// channels that were unset at that point do not keep stale values.
+		for (auto &entry : targets) {
+			Target &target = entry.second;
+			if (target.buffer) {
+				std::memset(target.buffer->data, 0, DMX_UNIVERSE_SIZE);
+				if (target.pass != pass) {
+					target.pass = pass;
+					touched.push_back(target.buffer);
+				}
+			}
+		}
+		reader.seek(time_usec);
+	}
+	reader.read_until(time_usec, [this](uint16_t universe, uint16_t length) -> uint8_t * {
+		DmxUniverseBuffer *buffer = resolve(universe);
+		if (!buffer) {
+			return nullptr;
+		}
+		buffer->length = artnet_dmx_length(length);
+		return buffer->data;
+	});
+	if (touched.empty()) {
+		return 0;
+	}
+	controller->get_output().send_universes(touched.data(), touched.size());
+	return static_cast<int>(touched.size());
+}
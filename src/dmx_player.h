@@ -0,0 +1,61 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/string.hpp"
+
+#include "artnet_controller.h"
+#include "dmx_recording.h"
+
+using namespace godot;
+
+// Plays a DmxRecorder file back into an ArtNetController. The file is memory
+// mapped and channel data is copied straight into the universe buffers.
+class DmxPlayer : public RefCounted {
+	GDCLASS(DmxPlayer, RefCounted)
+
+public:
+	enum PlaybackSource {
+		PLAYBACK_ALL,
+		PLAYBACK_SENT,
+		PLAYBACK_RECEIVED,
+	};
+
+protected:
+	static void _bind_methods();
+
+private:
+	struct Target {
+		DmxUniverseBuffer *buffer = nullptr;
+		uint32_t pass = 0;
+	};
+
+	DmxRecordingReader reader;
+	PlaybackSource source = PLAYBACK_ALL;
+
+	// Recorded universe -> buffer of the controller used last.
+	Ref<ArtNetController> bound_controller;
+	std::unordered_map<uint16_t, Target> targets;
+	std::vector<DmxUniverseBuffer *> touched;
+	uint32_t pass = 0;
+
+	DmxUniverseBuffer *resolve(uint16_t universe);
+
+public:
+	bool open(const String &path);
+	void close();
+	bool is_open() const;
+
+	double get_duration() const;
+	double get_position() const;
+
+	void set_source(PlaybackSource p_source);
+	PlaybackSource get_source() const;
+
+	int play_to(const Ref<ArtNetController> &controller, double position);
+};
+
+VARIANT_ENUM_CAST(DmxPlayer::PlaybackSource);
@@ -0,0 +1,73 @@
+#include "dmx_recorder.h"
+
+#include <algorithm>
+
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+
+void DmxRecorder::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("start", "controller", "path", "include_received"), &DmxRecorder::start, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("stop"), &DmxRecorder::stop);
+	ClassDB::bind_method(D_METHOD("is_recording"), &DmxRecorder::is_recording);
+	ClassDB::bind_method(D_METHOD("set_keyframe_interval", "seconds"), &DmxRecorder::set_keyframe_interval);
+	ClassDB::bind_method(D_METHOD("get_keyframe_interval"), &DmxRecorder::get_keyframe_interval);
+	ClassDB::bind_method(D_METHOD("get_frames_recorded"), &DmxRecorder::get_frames_recorded);
+	ClassDB::bind_method(D_METHOD("get_bytes_written"), &DmxRecorder::get_bytes_written);
+	ClassDB::bind_method(D_METHOD("get_duration"), &DmxRecorder::get_duration);
+}
+
+DmxRecorder::~DmxRecorder() {
+	stop();
+}
+
+bool DmxRecorder::start(const Ref<ArtNetController> &p_controller, const String &path, bool include_received) {
+	if (writer.is_open() || p_controller.is_null()) {
+		return false;
+	}
+	ArtNetOutput &output = p_controller->get_output();
+	if (output.get_recorder()) {
+		return false; // another recorder is attached
+	}
+	String file_path = ProjectSettings::get_singleton()->globalize_path(path);
+	if (!writer.open(file_path.utf8().get_data(), static_cast<int64_t>(keyframe_interval * 1000000.0))) {
+		return false;
+	}
+	controller = p_controller;
+	output.set_recorder(&writer, include_received);
+	return true;
+}
+
+void DmxRecorder::stop() {
+	if (controller.is_valid()) {
+		controller->get_output().set_recorder(nullptr, false);
+		controller.unref();
+	}
+	writer.close();
+}
+
+bool DmxRecorder::is_recording() const {
+	return writer.is_open();
+}
+
+void DmxRecorder::set_keyframe_interval(double seconds) {
+	// Applies to the next start().
+	keyframe_interval = std::clamp(seconds, 0.1, 3600.0);
+}
+
+double DmxRecorder::get_keyframe_interval() const {
+	return keyframe_interval;
+}
+
+int64_t DmxRecorder::get_frames_recorded() const {
+	return static_cast<int64_t>(writer.get_frame_count());
+}
+
+int64_t DmxRecorder::get_bytes_written() const {
+	return static_cast<int64_t>(writer.get_bytes_written());
+}
+
+double DmxRecorder::get_duration() const {
+	return static_cast<double>(writer.get_duration_usec()) / 1000000.0;
+}
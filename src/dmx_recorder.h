@@ -0,0 +1,38 @@
+#pragma once
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/string.hpp"
+
+#include "artnet_controller.h"
+#include "dmx_recording.h"
+
+using namespace godot;
+
+// Records the frames an ArtNetController sends (and optionally receives) to a
+// compact delta-encoded file that DmxPlayer can play back.
+class DmxRecorder : public RefCounted {
+	GDCLASS(DmxRecorder, RefCounted)
+
+protected:
+	static void _bind_methods();
+
+private:
+	DmxRecordingWriter writer;
+	Ref<ArtNetController> controller;
+	double keyframe_interval = 5.0;
+
+public:
+	~DmxRecorder();
+
+	bool start(const Ref<ArtNetController> &p_controller, const String &path, bool include_received = false);
+	void stop();
+	bool is_recording() const;
+
+	void set_keyframe_interval(double seconds);
+	double get_keyframe_interval() const;
+
+	int64_t get_frames_recorded() const;
+	int64_t get_bytes_written() const;
+	double get_duration() const;
+};
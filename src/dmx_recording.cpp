@@ -0,0 +1,503 @@
+#include "dmx_recording.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+void put_u16(uint8_t *dst, uint16_t value) {
+	dst[0] = static_cast<uint8_t>(value);
+	dst[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void put_u32(uint8_t *dst, uint32_t value) {
+	for (int i = 0; i < 4; i++) {
+		dst[i] = static_cast<uint8_t>(value >> (i * 8));
+	}
+}
+
+void put_u64(uint8_t *dst, uint64_t value) {
+	for (int i = 0; i < 8; i++) {
+		dst[i] = static_cast<uint8_t>(value >> (i * 8));
+	}
+}
+
+uint16_t get_u16(const uint8_t *src) {
+	return static_cast<uint16_t>(src[0] | (src[1] << 8));
+}
+
+uint32_t get_u32(const uint8_t *src) {
+	uint32_t value = 0;
+	for (int i = 3; i >= 0; i--) {
+		value = (value << 8) | src[i];
+	}
+	return value;
+}
+
+uint64_t get_u64(const uint8_t *src) {
+	uint64_t value = 0;
+	for (int i = 7; i >= 0; i--) {
+		value = (value << 8) | src[i];
+	}
+	return value;
+}
+
+// Appends a universe entry header and returns the offset of its run count.
+size_t append_universe_header(std::vector<uint8_t> &record, uint16_t universe, uint16_t length) {
+	size_t at = record.size();
+	record.resize(at + DMX_RECORDING_UNIVERSE_HEADER_SIZE);
+	put_u16(record.data() + at, universe);
+	put_u16(record.data() + at + 2, length);
+	put_u16(record.data() + at + 4, 0);
+	return at + 4;
+}
+
+void append_run(std::vector<uint8_t> &record, const uint8_t *data, uint16_t offset, uint16_t size) {
+	size_t at = record.size();
+	record.resize(at + DMX_RECORDING_RUN_HEADER_SIZE + size);
+	put_u16(record.data() + at, offset);
+	put_u16(record.data() + at + 2, size);
+	std::memcpy(record.data() + at + DMX_RECORDING_RUN_HEADER_SIZE, data + offset, size);
+}
+
+#ifdef _WIN32
+std::wstring widen(const std::string &path) {
+	int count = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+	std::wstring wide(count > 0 ? count : 1, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide[0], count);
+	return wide;
+}
+#endif
+
+} // namespace
+
+DmxRecordingWriter::~DmxRecordingWriter() {
+	close();
+}
+
+bool DmxRecordingWriter::write(const void *data, size_t count) {
+	if (std::fwrite(data, 1, count, file) != count) {
+		return false;
+	}
+	offset += count;
+	return true;
+}
+
+bool DmxRecordingWriter::open(const std::string &path, int64_t p_keyframe_interval_usec) {
+	if (file) {
+		return false;
+	}
+#ifdef _WIN32
+	file = _wfopen(widen(path).c_str(), L"wb");
+#else
+	file = std::fopen(path.c_str(), "wb");
+#endif
+	if (!file) {
+		return false;
+	}
+	// Large buffer: most frames are a few hundred bytes of deltas.
+	std::setvbuf(file, nullptr, _IOFBF, 1 << 18);
+
+	keyframe_interval_usec = std::max<int64_t>(p_keyframe_interval_usec, 1000);
+	offset = 0;
+	state_slot.assign(0x10000, -1);
+	states.clear();
+	index_time.clear();
+	index_offset.clear();
+	frames = 0;
+	last_time = 0;
+	in_frame = false;
+
+	uint8_t header[DMX_RECORDING_HEADER_SIZE] = {};
+	std::memcpy(header, DMX_RECORDING_MAGIC, sizeof(DMX_RECORDING_MAGIC));
+	put_u16(header + 8, DMX_RECORDING_VERSION);
+	put_u16(header + 10, 0);
+	put_u32(header + 12, static_cast<uint32_t>(keyframe_interval_usec / 1000));
+	if (!write(header, sizeof(header))) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void DmxRecordingWriter::close() {
+	if (!file) {
+		return;
+	}
+	// The index is a record of its own, so scanning readers skip it like any other.
+	uint64_t index_at = offset;
+	record.assign(DMX_RECORDING_RECORD_HEADER_SIZE + index_time.size() * DMX_RECORDING_INDEX_ENTRY_SIZE, 0);
+	put_u32(record.data(), static_cast<uint32_t>(record.size()));
+	record[4] = DMX_RECORD_INDEX;
+	put_u64(record.data() + 8, static_cast<uint64_t>(last_time));
+	for (size_t i = 0; i < index_time.size(); i++) {
+		uint8_t *entry = record.data() + DMX_RECORDING_RECORD_HEADER_SIZE + i * DMX_RECORDING_INDEX_ENTRY_SIZE;
+		put_u64(entry, static_cast<uint64_t>(index_time[i]));
+		put_u64(entry + 8, index_offset[i]);
+	}
+	uint8_t footer[DMX_RECORDING_FOOTER_SIZE];
+	put_u64(footer, index_at);
+	std::memcpy(footer + 8, DMX_RECORDING_INDEX_MAGIC, sizeof(DMX_RECORDING_INDEX_MAGIC));
+	write(record.data(), record.size());
+	write(footer, sizeof(footer));
+
+	std::fclose(file);
+	file = nullptr;
+	record.clear();
+	record.shrink_to_fit();
+}
+
+void DmxRecordingWriter::begin_frame(int64_t time_usec) {
+	if (!file) {
+		return;
+	}
+	if (frames == 0) {
+		start_usec = time_usec;
+	}
+	// Timestamps never go backwards in the file, whatever the caller passes.
+	frame_time = std::max(time_usec - start_usec, last_time);
+	keyframe = index_time.empty() || frame_time - last_keyframe >= keyframe_interval_usec;
+	record.resize(DMX_RECORDING_RECORD_HEADER_SIZE);
+	record_universes = 0;
+	in_frame = true;
+}
+
+void DmxRecordingWriter::add_universe(uint16_t universe, const uint8_t *data, uint16_t length) {
+	if (!in_frame || length > DMX_UNIVERSE_SIZE) {
+		return;
+	}
+	int32_t &slot = state_slot[universe];
+	bool seen = slot >= 0;
+	if (!seen) {
+		slot = static_cast<int32_t>(states.size());
+		states.emplace_back();
+		states.back().universe = universe;
+	}
+	UniverseState &state = states[static_cast<size_t>(slot)];
+
+	// Channels past the previously recorded length always count as changed,
+	// so a reader that started at a keyframe ends up with the same contents.
+	uint16_t known = seen ? std::min(state.length, length) : 0;
+	auto changed = [&](uint16_t channel) {
+		return channel >= known || state.data[channel] != data[channel];
+	};
+
+	// Keyframes are written in full from the states in end_frame().
+	if (!keyframe && (known != length || state.length != length || std::memcmp(state.data, data, length) != 0)) {
+		size_t run_count_at = append_universe_header(record, universe, length);
+		uint16_t runs = 0;
+		uint16_t i = 0;
+		while (i < length) {
+			if (!changed(i)) {
+				i++;
+				continue;
+			}
+			// Extend the run across gaps shorter than a run header, which are
+			// cheaper to carry than to split on.
+			uint16_t begin = i;
+			uint16_t end = ++i;
+			while (i < length && i - end < static_cast<int>(DMX_RECORDING_RUN_HEADER_SIZE)) {
+				if (changed(i)) {
+					end = static_cast<uint16_t>(i + 1);
+				}
+				i++;
+			}
+			i = end;
+			append_run(record, data, begin, static_cast<uint16_t>(end - begin));
+			runs++;
+		}
+		put_u16(record.data() + run_count_at, runs);
+		record_universes++;
+	}
+	std::memcpy(state.data, data, length);
+	state.length = length;
+}
+
+bool DmxRecordingWriter::end_frame() {
+	if (!in_frame) {
+		return false;
+	}
+	in_frame = false;
+	if (keyframe) {
+		record.resize(DMX_RECORDING_RECORD_HEADER_SIZE);
+		for (const UniverseState &state : states) {
+			size_t run_count_at = append_universe_header(record, state.universe, state.length);
+			if (state.length > 0) {
+				append_run(record, state.data, 0, state.length);
+				put_u16(record.data() + run_count_at, 1);
+			}
+		}
+		record_universes = static_cast<uint16_t>(states.size());
+		if (record_universes == 0) {
+			return true; // nothing to key yet
+		}
+		index_time.push_back(frame_time);
+		index_offset.push_back(offset);
+		last_keyframe = frame_time;
+	} else if (record_universes == 0) {
+		return true;
+	}
+
+	put_u32(record.data(), static_cast<uint32_t>(record.size()));
+	record[4] = keyframe ? DMX_RECORD_KEYFRAME : DMX_RECORD_DELTA;
+	record[5] = 0;
+	put_u16(record.data() + 6, record_universes);
+	put_u64(record.data() + 8, static_cast<uint64_t>(frame_time));
+	if (!write(record.data(), record.size())) {
+		return false;
+	}
+	frames++;
+	last_time = frame_time;
+	return true;
+}
+
+DmxRecordingReader::~DmxRecordingReader() {
+	close();
+}
+
+bool DmxRecordingReader::map(const std::string &path) {
+#ifdef _WIN32
+	HANDLE handle = CreateFileW(widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(handle, &file_size) || file_size.QuadPart == 0) {
+		CloseHandle(handle);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(handle);
+		return false;
+	}
+	void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		CloseHandle(handle);
+		return false;
+	}
+	file_handle = handle;
+	mapping_handle = mapping;
+	base = static_cast<const uint8_t *>(view);
+	size = static_cast<size_t>(file_size.QuadPart);
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping keeps the file open
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	// Playback reads front to back, so let the kernel read ahead.
+	madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+	base = static_cast<const uint8_t *>(view);
+	size = static_cast<size_t>(info.st_size);
+#endif
+	return true;
+}
+
+void DmxRecordingReader::unmap() {
+	if (!base) {
+		return;
+	}
+#ifdef _WIN32
+	UnmapViewOfFile(base);
+	CloseHandle(static_cast<HANDLE>(mapping_handle));
+	CloseHandle(static_cast<HANDLE>(file_handle));
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+#else
+	munmap(const_cast<uint8_t *>(base), size);
+#endif
+	base = nullptr;
+	size = 0;
+}
+
+bool DmxRecordingReader::open(const std::string &path) {
+	close();
+	if (!map(path)) {
+		return false;
+	}
+	if (size < DMX_RECORDING_HEADER_SIZE || std::memcmp(base, DMX_RECORDING_MAGIC, sizeof(DMX_RECORDING_MAGIC)) != 0 || get_u16(base + 8) != DMX_RECORDING_VERSION) {
+		unmap();
+		return false;
+	}
+	if (!load_index()) {
+		scan_index();
+	}
+	cursor = DMX_RECORDING_HEADER_SIZE;
+	position = -1;
+	return true;
+}
+
+void DmxRecordingReader::close() {
+	unmap();
+	index_time.clear();
+	index_offset.clear();
+	data_end = 0;
+	duration = 0;
+	cursor = 0;
+	position = -1;
+}
+
+bool DmxRecordingReader::load_index() {
+	if (size < DMX_RECORDING_HEADER_SIZE + DMX_RECORDING_RECORD_HEADER_SIZE + DMX_RECORDING_FOOTER_SIZE) {
+		return false;
+	}
+	const uint8_t *footer = base + size - DMX_RECORDING_FOOTER_SIZE;
+	if (std::memcmp(footer + 8, DMX_RECORDING_INDEX_MAGIC, sizeof(DMX_RECORDING_INDEX_MAGIC)) != 0) {
+		return false;
+	}
+	uint64_t index_at = get_u64(footer);
+	if (index_at < DMX_RECORDING_HEADER_SIZE || index_at + DMX_RECORDING_RECORD_HEADER_SIZE > size - DMX_RECORDING_FOOTER_SIZE) {
+		return false;
+	}
+	const uint8_t *record = base + index_at;
+	uint32_t record_size = get_u32(record);
+	if (record[4] != DMX_RECORD_INDEX || index_at + record_size != size - DMX_RECORDING_FOOTER_SIZE) {
+		return false;
+	}
+	size_t count = (record_size - DMX_RECORDING_RECORD_HEADER_SIZE) / DMX_RECORDING_INDEX_ENTRY_SIZE;
+	index_time.resize(count);
+	index_offset.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		const uint8_t *entry = record + DMX_RECORDING_RECORD_HEADER_SIZE + i * DMX_RECORDING_INDEX_ENTRY_SIZE;
+		index_time[i] = static_cast<int64_t>(get_u64(entry));
+		index_offset[i] = get_u64(entry + 8);
+		if (index_offset[i] < DMX_RECORDING_HEADER_SIZE || index_offset[i] >= index_at) {
+			index_time.clear();
+			index_offset.clear();
+			return false;
+		}
+	}
+	duration = static_cast<int64_t>(get_u64(record + 8));
+	data_end = static_cast<size_t>(index_at);
+	return true;
+}
+
+void DmxRecordingReader::scan_index() {
+	index_time.clear();
+	index_offset.clear();
+	duration = 0;
+	size_t at = DMX_RECORDING_HEADER_SIZE;
+	while (at + DMX_RECORDING_RECORD_HEADER_SIZE <= size) {
+		uint32_t record_size = get_u32(base + at);
+		uint8_t type = base[at + 4];
+		if (record_size < DMX_RECORDING_RECORD_HEADER_SIZE || record_size > size - at || type == DMX_RECORD_INDEX) {
+			break; // torn write at the end of an unclosed file
+		}
+		int64_t time = static_cast<int64_t>(get_u64(base + at + 8));
+		if (type == DMX_RECORD_KEYFRAME) {
+			index_time.push_back(time);
+			index_offset.push_back(at);
+		}
+		duration = std::max(duration, time);
+		at += record_size;
+	}
+	data_end = at;
+}
+
+bool DmxRecordingReader::apply(size_t record_offset, const Target &target) const {
+	const uint8_t *record = base + record_offset;
+	const uint8_t *end = record + get_u32(record);
+	uint16_t universe_count = get_u16(record + 6);
+	const uint8_t *at = record + DMX_RECORDING_RECORD_HEADER_SIZE;
+	for (uint16_t u = 0; u < universe_count; u++) {
+		if (at + DMX_RECORDING_UNIVERSE_HEADER_SIZE > end) {
+			return false;
+		}
+		uint16_t universe = get_u16(at);
+		uint16_t length = get_u16(at + 2);
+		uint16_t run_count = get_u16(at + 4);
+		at += DMX_RECORDING_UNIVERSE_HEADER_SIZE;
+		uint8_t *destination = length <= DMX_UNIVERSE_SIZE ? target(universe, length) : nullptr;
+		for (uint16_t r = 0; r < run_count; r++) {
+			if (at + DMX_RECORDING_RUN_HEADER_SIZE > end) {
+				return false;
+			}
+			uint16_t offset = get_u16(at);
+			uint16_t run_size = get_u16(at + 2);
+			at += DMX_RECORDING_RUN_HEADER_SIZE;
+			if (at + run_size > end) {
+				return false;
+			}
+			if (destination && static_cast<size_t>(offset) + run_size <= DMX_UNIVERSE_SIZE) {
+				std::memcpy(destination + offset, at, run_size);
+			}
+			at += run_size;
+		}
+	}
+	return true;
+}
+
+bool DmxRecordingReader::should_seek(int64_t time_usec) const {
+	if (time_usec < position) {
+		return true;
+	}
+	// Index of the first keyframe after the current position.
+	auto next = std::upper_bound(index_time.begin(), index_time.end(), position);
+	return next != index_time.end() && *next <= time_usec && index_offset[static_cast<size_t>(next - index_time.begin())] > cursor;
+}
+
+void DmxRecordingReader::seek(int64_t time_usec) {
+	auto key = std::upper_bound(index_time.begin(), index_time.end(), time_usec);
+	if (key == index_time.begin()) {
+		cursor = DMX_RECORDING_HEADER_SIZE;
+	} else {
+		cursor = static_cast<size_t>(index_offset[static_cast<size_t>(key - index_time.begin()) - 1]);
+	}
+	position = -1;
+}
+
+size_t DmxRecordingReader::read_until(int64_t time_usec, const Target &target) {
+	if (!base) {
+		return 0;
+	}
+	size_t applied = 0;
+	while (cursor + DMX_RECORDING_RECORD_HEADER_SIZE <= data_end) {
+		const uint8_t *record = base + cursor;
+		uint32_t record_size = get_u32(record);
+		if (record_size < DMX_RECORDING_RECORD_HEADER_SIZE || record_size > data_end - cursor) {
+			break;
+		}
+		int64_t time = static_cast<int64_t>(get_u64(record + 8));
+		if (time > time_usec) {
+			break;
+		}
+		if (record[4] == DMX_RECORD_DELTA || record[4] == DMX_RECORD_KEYFRAME) {
+			if (!apply(cursor, target)) {
+				break;
+			}
+			applied++;
+		}
+		position = time;
+		cursor += record_size;
+	}
+	if (position < time_usec) {
+		position = time_usec;
+	}
+	return applied;
+}
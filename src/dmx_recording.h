@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "artnet_protocol.h"
+
+// Compact DMX show recordings. A file is a fixed header followed by an
+// append-only stream of timestamped records, closed by a seek index:
+//
+//   header   "GDDMXREC", u16 version, u16 flags, u32 keyframe interval (ms), 16 reserved bytes
+//   record   u32 size, u8 type, u8 reserved, u16 universe count, i64 time (usec from start)
+//            then per universe: u16 universe, u16 length, u16 run count,
+//            and per run: u16 offset, u16 size, size bytes of channel data
+//   index    a record of type INDEX holding (i64 time, u64 offset) per keyframe
+//   footer   u64 index offset, "GDDMXIDX"
+//
+// Delta records only carry the channel runs that changed since the previous
+// record for that universe. Keyframes carry every universe seen so far in
+// full, so playback can start at any keyframe. All integers are little-endian.
+// A file that was not closed has no footer; readers then rebuild the index
+// by scanning the records and ignore a torn record at the end.
+static constexpr uint8_t DMX_RECORDING_MAGIC[8] = { 'G', 'D', 'D', 'M', 'X', 'R', 'E', 'C' };
+static constexpr uint8_t DMX_RECORDING_INDEX_MAGIC[8] = { 'G', 'D', 'D', 'M', 'X', 'I', 'D', 'X' };
+static constexpr uint16_t DMX_RECORDING_VERSION = 1;
+static constexpr size_t DMX_RECORDING_HEADER_SIZE = 32;
+static constexpr size_t DMX_RECORDING_RECORD_HEADER_SIZE = 16;
+static constexpr size_t DMX_RECORDING_UNIVERSE_HEADER_SIZE = 6;
+static constexpr size_t DMX_RECORDING_RUN_HEADER_SIZE = 4;
+static constexpr size_t DMX_RECORDING_INDEX_ENTRY_SIZE = 16;
+static constexpr size_t DMX_RECORDING_FOOTER_SIZE = 16;
+
+// Universe numbers are 15-bit Port-Addresses; bit 15 marks received data.
+static constexpr uint16_t DMX_RECORDING_RECEIVED = 0x8000;
+
+enum DmxRecordType : uint8_t {
+	DMX_RECORD_DELTA = 1,
+	DMX_RECORD_KEYFRAME = 2,
+	DMX_RECORD_INDEX = 3,
+};
+
+// Appends frames to a recording. Not thread-safe; call it from the thread
+// that sends or polls the universes.
+class DmxRecordingWriter {
+	struct UniverseState {
+		uint16_t universe = 0;
+		uint16_t length = 0;
+		uint8_t data[DMX_UNIVERSE_SIZE] = {};
+	};
+
+	std::FILE *file = nullptr;
+	uint64_t offset = 0; // bytes written so far
+	int64_t keyframe_interval_usec = 5000000;
+
+	// Last recorded contents per universe, looked up through a flat table.
+	std::vector<int32_t> state_slot; // universe -> index into states, -1 if unseen
+	std::vector<UniverseState> states;
+
+	std::vector<uint8_t> record; // record being built, reused
+	std::vector<int64_t> index_time;
+	std::vector<uint64_t> index_offset;
+	int64_t start_usec = 0;
+	int64_t frame_time = 0;
+	int64_t last_keyframe = 0;
+	int64_t last_time = 0;
+	uint16_t record_universes = 0;
+	bool keyframe = false;
+	bool in_frame = false;
+	uint64_t frames = 0;
+
+	bool write(const void *data, size_t size);
+
+public:
+	~DmxRecordingWriter();
+
+	bool open(const std::string &path, int64_t p_keyframe_interval_usec);
+	// Writes the seek index and closes the file.
+	void close();
+	bool is_open() const { return file != nullptr; }
+
+	// One frame: any number of universes sharing a timestamp on the steady
+	// clock. Universes whose contents did not change add nothing to the file.
+	void begin_frame(int64_t time_usec);
+	void add_universe(uint16_t universe, const uint8_t *data, uint16_t length);
+	bool end_frame();
+
+	uint64_t get_frame_count() const { return frames; }
+	uint64_t get_bytes_written() const { return offset; }
+	int64_t get_duration_usec() const { return last_time; }
+};
+
+// Plays a recording back from a read-only memory map. Channel data is copied
+// straight from the mapped file into the destination, so memory use does not
+// grow with the length of the recording and only the pages being played are
+// read from disk.
+class DmxRecordingReader {
+public:
+	// Returns the buffer a universe is written into, or nullptr to skip it.
+	// length is the recorded packet length; data past it is left alone.
+	using Target = std::function<uint8_t *(uint16_t universe, uint16_t length)>;
+
+private:
+	const uint8_t *base = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void *file_handle = nullptr;
+	void *mapping_handle = nullptr;
+#endif
+
+	size_t data_end = 0; // end of the record stream
+	std::vector<int64_t> index_time;
+	std::vector<uint64_t> index_offset;
+	int64_t duration = 0;
+
+	size_t cursor = 0; // next record to apply
+	int64_t position = -1; // time of the last record applied, -1 before the first
+
+	bool map(const std::string &path);
+	void unmap();
+	bool load_index();
+	void scan_index();
+	bool apply(size_t record_offset, const Target &target) const;
+
+public:
+	~DmxRecordingReader();
+
+	bool open(const std::string &path);
+	void close();
+	bool is_open() const { return base != nullptr; }
+
+	int64_t get_duration_usec() const { return duration; }
+	size_t get_keyframe_count() const { return index_time.size(); }
+	int64_t get_position_usec() const { return position; }
+
+	// True when reaching time_usec by reading on would be slower than seeking:
+	// it lies before the current position or past the next keyframe.
+	bool should_seek(int64_t time_usec) const;
+	// Moves playback to the last keyframe at or before time_usec; the next
+	// read_until() replays from there. Destinations keep their contents, so
+	// clear them first when seeking backwards.
+	void seek(int64_t time_usec);
+	// Applies every record up to and including time_usec. Returns the number
+	// of records applied.
+	size_t read_until(int64_t time_usec, const Target &target);
+};
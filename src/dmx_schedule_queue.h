@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "artnet_protocol.h"
+
+struct DmxUniverseBuffer;
+
+// One universe frame waiting to be sent at target_usec (steady clock).
+struct DmxScheduledFrame {
+	int64_t target_usec = 0;
+	DmxUniverseBuffer *universe = nullptr;
+	uint64_t generation = 0; // universe generation when queued; older commits are superseded
+	uint16_t length = 0;
+	uint8_t data[DMX_UNIVERSE_SIZE];
+};
+
+// Bounded single-producer, single-consumer FIFO between the game thread and
+// the sender thread. The slots are allocated once by reserve(); pushing and
+// popping only move two atomic indices, so neither side allocates or waits.
+template <typename Frame>
+class DmxFrameQueue {
+	std::unique_ptr<Frame[]> slots;
+	size_t capacity = 0;
+
+	alignas(64) std::atomic<size_t> head{ 0 }; // consumer-owned
+	alignas(64) std::atomic<size_t> tail{ 0 }; // producer-owned
+	std::atomic<size_t> clear_mark{ 0 }; // tail at the last clear request plus one, 0 if none
+
+public:
+	// Allocates room for capacity frames and empties the queue. Only call
+	// while neither side is using the queue.
+	void reserve(size_t p_capacity) {
+		if (p_capacity != capacity) {
+			slots.reset(p_capacity ? new Frame[p_capacity] : nullptr);
+			capacity = p_capacity;
+		}
+		reset();
+	}
+
+	// Empties the queue. Only call while neither side is using the queue.
+	void reset() {
+		head.store(0, std::memory_order_relaxed);
+		tail.store(0, std::memory_order_relaxed);
+		clear_mark.store(0, std::memory_order_relaxed);
+	}
+
+	size_t get_capacity() const { return capacity; }
+
+	// Approximate from either side; exact on the side that owns the change.
+	size_t size() const {
+		size_t position = head.load(std::memory_order_acquire);
+		return tail.load(std::memory_order_acquire) - position;
+	}
+
+	// Producer: returns the slot to fill for the n-th frame after the ones
+	// already pushed, or nullptr if the queue cannot take that many.
+	Frame *prepare(size_t n) {
+		size_t position = tail.load(std::memory_order_relaxed) + n;
+		if (position - head.load(std::memory_order_acquire) >= capacity) {
+			return nullptr;
+		}
+		return &slots[position % capacity];
+	}
+
+	// Producer: makes the next count prepared frames visible to the consumer.
+	void push(size_t count) {
+		tail.store(tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	// Producer: asks the consumer to drop everything queued so far. Frames
+	// pushed after the request are kept.
+	void request_clear() { clear_mark.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+	// Consumer: true once request_clear() was called and not yet handled.
+	bool clear_pending() const { return clear_mark.load(std::memory_order_acquire) != 0; }
+
+	// Consumer: drops every frame pushed before the pending clear request.
+	// Returns the number of frames dropped.
+	size_t handle_clear() {
+		size_t mark = clear_mark.exchange(0, std::memory_order_acq_rel);
+		size_t position = head.load(std::memory_order_relaxed);
+		if (mark == 0 || mark - 1 <= position) {
+			return 0;
+		}
+		head.store(mark - 1, std::memory_order_release);
+		return mark - 1 - position;
+	}
+
+	// Consumer: the oldest frame, or nullptr if the queue is empty.
+	const Frame *front() const {
+		size_t position = head.load(std::memory_order_relaxed);
+		if (position == tail.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+		return &slots[position % capacity];
+	}
+
+	// Consumer: releases the frame returned by front().
+	void pop() {
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+};
+
+// Scheduled frames are queued in timestamp order, which keeps the earliest
+// frame at the head without any sorting on the sender thread.
+using DmxScheduleQueue = DmxFrameQueue<DmxScheduledFrame>;
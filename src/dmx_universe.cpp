@@ -0,0 +1,91 @@
+#include "dmx_universe.h"
+
+#include <cstring>
+
+#include <godot_cpp/core/class_db.hpp>
+
+using namespace godot;
+
+void DmxUniverse::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_universe"), &DmxUniverse::get_universe);
+	ClassDB::bind_method(D_METHOD("get_length"), &DmxUniverse::get_length);
+	ClassDB::bind_method(D_METHOD("set_length", "length"), &DmxUniverse::set_length);
+	ClassDB::bind_method(D_METHOD("set_channel", "channel", "value"), &DmxUniverse::set_channel);
+	ClassDB::bind_method(D_METHOD("get_channel", "channel"), &DmxUniverse::get_channel);
+	ClassDB::bind_method(D_METHOD("write", "offset", "data"), &DmxUniverse::write);
+	ClassDB::bind_method(D_METHOD("fill", "value"), &DmxUniverse::fill);
+	ClassDB::bind_method(D_METHOD("get_data"), &DmxUniverse::get_data);
+}
+
+void DmxUniverse::setup(const Ref<RefCounted> &p_owner, DmxUniverseBuffer *p_buffer) {
+	owner = p_owner;
+	buffer = p_buffer;
+}
+
+int DmxUniverse::get_universe() const {
+	if (!buffer) {
+		return -1;
+	}
+	return buffer->port_address;
+}
+
+int DmxUniverse::get_length() const {
+	if (!buffer) {
+		return 0;
+	}
+	return buffer->length;
+}
+
+void DmxUniverse::set_length(int length) {
+	if (buffer && length > 0) {
+		buffer->length = artnet_dmx_length(static_cast<size_t>(length));
+	}
+}
+
+bool DmxUniverse::set_channel(int channel, int value) {
+	if (!buffer || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE)) {
+		return false;
+	}
+	buffer->data[channel] = static_cast<uint8_t>(value);
+	if (channel >= buffer->length) {
+		buffer->length = artnet_dmx_length(static_cast<size_t>(channel) + 1);
+	}
+	return true;
+}
+
+int DmxUniverse::get_channel(int channel) const {
+	if (!buffer || channel < 0 || channel >= static_cast<int>(DMX_UNIVERSE_SIZE)) {
+		return 0;
+	}
+	return buffer->data[channel];
+}
+
+bool DmxUniverse::write(int offset, const PackedByteArray &data) {
+	if (!buffer || offset < 0 || offset + data.size() > static_cast<int64_t>(DMX_UNIVERSE_SIZE)) {
+		return false;
+	}
+	if (data.is_empty()) {
+		return true;
+	}
+	std::memcpy(buffer->data + offset, data.ptr(), data.size());
+	size_t end = static_cast<size_t>(offset + data.size());
+	if (end > buffer->length) {
+		buffer->length = artnet_dmx_length(end);
+	}
+	return true;
+}
+
+void DmxUniverse::fill(int value) {
+	if (buffer) {
+		std::memset(buffer->data, static_cast<uint8_t>(value), DMX_UNIVERSE_SIZE);
+	}
+}
+
+PackedByteArray DmxUniverse::get_data() const {
+	PackedByteArray data;
+	if (buffer) {
+		data.resize(buffer->length);
+		std::memcpy(data.ptrw(), buffer->data, buffer->length);
+	}
+	return data;
+}
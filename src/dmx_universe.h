@@ -0,0 +1,39 @@
+#pragma once
+
+#include "godot_cpp/classes/ref_counted.hpp"
+#include "godot_cpp/classes/wrapped.hpp"
+#include "godot_cpp/variant/packed_byte_array.hpp"
+
+#include "artnet_output.h"
+
+using namespace godot;
+
+// Handle to a universe buffer owned by an ArtNetController. Writes go
+// straight into the buffer the ArtDmx packet is sent from.
+class DmxUniverse : public RefCounted {
+	GDCLASS(DmxUniverse, RefCounted)
+
+protected:
+	static void _bind_methods();
+
+private:
+	Ref<RefCounted> owner; // keeps the controller that owns buffer alive
+	DmxUniverseBuffer *buffer = nullptr;
+
+public:
+	void setup(const Ref<RefCounted> &p_owner, DmxUniverseBuffer *p_buffer);
+
+	int get_universe() const;
+	int get_length() const;
+	void set_length(int length);
+
+	bool set_channel(int channel, int value);
+	int get_channel(int channel) const;
+	bool write(int offset, const PackedByteArray &data);
+	void fill(int value);
+	PackedByteArray get_data() const;
+
+	// Direct access for native callers.
+	uint8_t *ptrw() { return buffer ? buffer->data : nullptr; }
+	const uint8_t *ptr() const { return buffer ? buffer->data : nullptr; }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "artnet_protocol.h"
+
+// Dense storage for per-universe buffers. Buffers are handed out in slots,
+// in creation order, from chunks of CHUNK_SIZE contiguous 64-byte aligned
+// buffers. Chunks never move, so pointers to buffers stay valid until
+// clear(). Port-Addresses map to slots through a flat table covering the
+// whole 15-bit range (64 KiB), so a lookup is a single indexed load instead
+// of a tree or hash walk.
+template <typename T, size_t CHUNK_SIZE = 16>
+class DmxUniverseArena {
+	static constexpr uint16_t NO_SLOT = 0xFFFF;
+	static constexpr size_t TABLE_SIZE = ARTNET_MAX_PORT_ADDRESS + 1;
+
+	std::vector<std::unique_ptr<T[]>> chunks;
+	std::unique_ptr<uint16_t[]> slots; // Port-Address -> slot, allocated on first insert
+	size_t count = 0;
+
+public:
+	T *find(uint16_t port_address) const {
+		if (!slots || port_address >= TABLE_SIZE) {
+			return nullptr;
+		}
+		uint16_t slot = slots[port_address];
+		return slot == NO_SLOT ? nullptr : &at(slot);
+	}
+
+	// Returns the buffer for port_address, taking the next free slot on first use.
+	T *insert(uint16_t port_address) {
+		if (port_address >= TABLE_SIZE) {
+			return nullptr;
+		}
+		if (!slots) {
+			slots.reset(new uint16_t[TABLE_SIZE]);
+			std::fill(slots.get(), slots.get() + TABLE_SIZE, NO_SLOT);
+		}
+		uint16_t &slot = slots[port_address];
+		if (slot == NO_SLOT) {
+			if (count == chunks.size() * CHUNK_SIZE) {
+				chunks.emplace_back(new T[CHUNK_SIZE]);
+			}
+			slot = static_cast<uint16_t>(count++);
+		}
+		return &at(slot);
+	}
+
+	T &at(size_t slot) const { return chunks[slot / CHUNK_SIZE][slot % CHUNK_SIZE]; }
+	size_t size() const { return count; }
+
+	void clear() {
+		chunks.clear();
+		if (slots) {
+			std::fill(slots.get(), slots.get() + TABLE_SIZE, NO_SLOT);
+		}
+		count = 0;
+	}
+};
@@ -1,26 +1,56 @@
 #include "register_types.h"
 
 #include <gdextension_interface.h>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/defs.hpp>
 #include <godot_cpp/godot.hpp>
 
 #include "artnet_controller.h"
+#include "artnet_engine.h"
+#include "dmx_layer.h"
+#include "dmx_node_simulator.h"
+#include "dmx_patch.h"
+#include "dmx_pixel_mapper.h"
+#include "dmx_player.h"
+#include "dmx_recorder.h"
+#include "dmx_universe.h"
 
 using namespace godot;
 
+static ArtNetEngine *artnet_engine = nullptr;
+
 void initialize_gdextension_types(ModuleInitializationLevel p_level)
 {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+	GDREGISTER_CLASS(ArtNetEngine);
 	GDREGISTER_CLASS(ArtNetController);
+	GDREGISTER_CLASS(DmxUniverse);
+	GDREGISTER_CLASS(DmxLayer);
+	GDREGISTER_CLASS(DmxNodeSimulator);
+	GDREGISTER_CLASS(DmxPatch);
+	GDREGISTER_CLASS(DmxPixelMapper);
+	GDREGISTER_CLASS(DmxRecorder);
+	GDREGISTER_CLASS(DmxPlayer);
+
+	artnet_engine = memnew(ArtNetEngine);
+	Engine::get_singleton()->register_singleton("ArtNetEngine", artnet_engine);
+
+	// Send path counters show up in the debugger's Monitors tab and can be
+	// read through Performance.get_custom_monitor() in exported builds.
+	artnet_engine->add_performance_monitors();
 }
 
 void uninitialize_gdextension_types(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+	artnet_engine->remove_performance_monitors();
+	Engine::get_singleton()->unregister_singleton("ArtNetEngine");
+	memdelete(artnet_engine);
+	artnet_engine = nullptr;
 }
 
 extern "C"
@@ -0,0 +1,179 @@
+#include "sacn_output.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include "artnet_output.h"
+#include "artnet_stats.h"
+#include "artnet_transport.h"
+
+SacnOutput::SacnOutput() {
+	// Version 4 (random) UUID.
+	std::random_device device;
+	for (size_t i = 0; i < SACN_CID_SIZE; i += 4) {
+		uint32_t value = device();
+		std::memcpy(cid + i, &value, sizeof(value));
+	}
+	cid[6] = static_cast<uint8_t>((cid[6] & 0x0F) | 0x40);
+	cid[8] = static_cast<uint8_t>((cid[8] & 0x3F) | 0x80);
+	std::strncpy(source_name, "Godot Art-Net", sizeof(source_name) - 1);
+}
+
+SacnOutput::~SacnOutput() {
+	close(nullptr, 0);
+}
+
+bool SacnOutput::configure(const std::string &bind_address, const std::string &p_source_name, int p_universe_offset, uint16_t destination_port) {
+	if (opened || destination_port == 0) {
+		return false;
+	}
+	ArtNetAddress bind;
+	if (!ArtNetAddress::parse(bind_address, 0, bind)) {
+		return false;
+	}
+	endpoint = ArtNetTransport::get_singleton().get_endpoint(bind);
+
+	std::memset(source_name, 0, sizeof(source_name));
+	std::strncpy(source_name, p_source_name.c_str(), sizeof(source_name) - 1);
+	universe_offset = p_universe_offset;
+	port = destination_port;
+	header_epoch.fetch_add(1, std::memory_order_release);
+	return true;
+}
+
+bool SacnOutput::open() {
+	if (opened) {
+		return true;
+	}
+	if (!endpoint) {
+		configure("0.0.0.0", source_name, universe_offset, port);
+	}
+	if (!endpoint->open()) {
+		return false;
+	}
+	// Without this the kernel picks the interface for multicast from the routing table.
+	if (endpoint->get_bind_address().ip != 0) {
+		endpoint->get_socket().set_multicast_interface(endpoint->get_bind_address());
+	}
+	opened = true;
+	return true;
+}
+
+void SacnOutput::close(DmxUniverseBuffer *const *list, size_t count) {
+	if (!opened) {
+		return;
+	}
+	// E1.31 6.2.6: announce termination with three packets per universe so
+	// receivers release the source at once instead of after the data loss timeout.
+	for (int i = 0; i < 3; i++) {
+		send(list, count, -1, SACN_OPTION_STREAM_TERMINATED, false);
+	}
+	endpoint->close();
+	opened = false;
+}
+
+void SacnOutput::set_priority(int p_priority) {
+	priority = std::clamp(p_priority, 0, static_cast<int>(SACN_MAX_PRIORITY));
+	header_epoch.fetch_add(1, std::memory_order_release);
+}
+
+void SacnOutput::set_sync_universe(int universe) {
+	sync_universe = universe >= SACN_MIN_UNIVERSE && universe <= SACN_MAX_UNIVERSE ? universe : 0;
+	header_epoch.fetch_add(1, std::memory_order_release);
+}
+
+bool SacnOutput::map_universe(uint16_t port_address, uint16_t &r_universe) const {
+	int universe = port_address + universe_offset;
+	if (universe < SACN_MIN_UNIVERSE || universe > SACN_MAX_UNIVERSE) {
+		return false;
+	}
+	r_universe = static_cast<uint16_t>(universe);
+	return true;
+}
+
+bool SacnOutput::send(DmxUniverseBuffer *const *list, size_t count, int frame, uint8_t options, bool latch) {
+	if (!opened) {
+		return false;
+	}
+	ArtNetSocket &socket = endpoint->get_socket();
+	// Loaded first: a setter stores its value before bumping the epoch.
+	uint32_t epoch = header_epoch.load(std::memory_order_acquire);
+	uint8_t packet_priority = static_cast<uint8_t>(priority.load(std::memory_order_relaxed));
+	uint16_t sync = static_cast<uint16_t>(sync_universe.load(std::memory_order_relaxed));
+
+	ArtNetAddress destinations[ArtNetSocket::MAX_BATCH];
+	ArtNetDatagram datagrams[ArtNetSocket::MAX_BATCH];
+	bool datagram_sent[ArtNetSocket::MAX_BATCH];
+	DmxUniverseBuffer *datagram_universe[ArtNetSocket::MAX_BATCH];
+	size_t datagram_count = 0;
+	bool success = true;
+
+	auto flush = [&]() {
+		int error = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		size_t sent = socket.send_batch(datagrams, datagram_count, &error, datagram_sent);
+		uint64_t latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		size_t bytes = 0;
+		for (size_t i = 0; i < datagram_count; i++) {
+			if (datagram_sent[i]) {
+				bytes += datagrams[i].header_size + datagrams[i].payload_size;
+			} else {
+				datagram_universe[i]->resend = true;
+			}
+		}
+		ArtNetStats::get_singleton().record_send(datagram_count, sent, bytes, latency, error);
+		packets_sent.fetch_add(sent, std::memory_order_relaxed);
+		if (sent != datagram_count) {
+			success = false;
+		}
+		datagram_count = 0;
+	};
+
+	for (size_t i = 0; i < count; i++) {
+		DmxUniverseBuffer &universe = *list[i];
+		uint16_t universe_number;
+		if (!map_universe(universe.port_address, universe_number)) {
+			continue;
+		}
+		if (datagram_count == ArtNetSocket::MAX_BATCH) {
+			flush();
+		}
+
+		uint16_t length = frame < 0 ? universe.length : universe.frame_length[frame];
+		uint8_t *header = universe.sacn_header;
+		if (universe.sacn_header_epoch != epoch) {
+			sacn_write_data_header(header, cid, source_name, packet_priority, sync, universe.sacn_sequence++, options, universe_number, length);
+			universe.sacn_header_epoch = epoch;
+		} else {
+			sacn_patch_data_header(header, universe.sacn_sequence++, options, length);
+		}
+
+		ArtNetAddress &destination = destinations[datagram_count];
+		destination.ip = sacn_multicast_ip(universe_number);
+		destination.port = port;
+
+		datagram_universe[datagram_count] = &universe;
+		ArtNetDatagram &datagram = datagrams[datagram_count++];
+		datagram.destination = &destination;
+		datagram.header = header;
+		datagram.header_size = SACN_DATA_HEADER_SIZE;
+		datagram.payload = frame < 0 ? universe.data : universe.frames[frame];
+		datagram.payload_size = length;
+	}
+	if (datagram_count > 0) {
+		flush();
+	}
+
+	if (latch && sync != 0 && count > 0) {
+		uint8_t packet[SACN_SYNC_SIZE];
+		sacn_write_sync(packet, cid, sync_sequence++, sync);
+		ArtNetAddress destination;
+		destination.ip = sacn_multicast_ip(sync);
+		destination.port = port;
+		if (!socket.send_to(destination, packet, sizeof(packet))) {
+			success = false;
+		}
+	}
+	return success;
+}
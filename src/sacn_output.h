@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "artnet_socket.h"
+#include "sacn_protocol.h"
+
+class ArtNetEndpoint;
+struct DmxUniverseBuffer;
+
+// E1.31 (sACN) sender driven by an ArtNetOutput. It owns no universe data:
+// every packet is built straight from the same DmxUniverseBuffer slabs and
+// frame snapshots the Art-Net path sends, so one write of channel data feeds
+// both protocols. Art-Net Port-Address N goes out as sACN universe
+// N + universe_offset, multicast to that universe's group.
+class SacnOutput {
+	std::shared_ptr<ArtNetEndpoint> endpoint;
+	bool opened = false;
+
+	uint8_t cid[SACN_CID_SIZE] = {};
+	char source_name[SACN_SOURCE_NAME_SIZE] = {};
+	int universe_offset = 1;
+	uint16_t port = SACN_DEFAULT_PORT;
+
+	std::atomic<int> priority{ SACN_DEFAULT_PRIORITY };
+	std::atomic<int> sync_universe{ 0 };
+	// Bumped whenever a field baked into the universes' header templates
+	// changes, so the sending thread rebuilds them on its next pass.
+	std::atomic<uint32_t> header_epoch{ 1 };
+	std::atomic<uint64_t> packets_sent{ 0 };
+
+	// Owned by whichever thread sends.
+	uint8_t sync_sequence = 0;
+
+	bool map_universe(uint16_t port_address, uint16_t &r_universe) const;
+	bool send(DmxUniverseBuffer *const *list, size_t count, int frame, uint8_t options, bool latch);
+
+public:
+	// Generates a random CID that identifies this source for its lifetime.
+	SacnOutput();
+	~SacnOutput();
+
+	// Only allowed while closed. The socket is bound to bind_address on an
+	// ephemeral port and shared with other sACN outputs on that interface.
+	bool configure(const std::string &bind_address, const std::string &p_source_name, int p_universe_offset, uint16_t destination_port = SACN_DEFAULT_PORT);
+
+	bool open();
+	// Sends the E1.31 stream-terminated notice for the given universes, then closes.
+	void close(DmxUniverseBuffer *const *list, size_t count);
+	bool is_open() const { return opened; }
+
+	void set_priority(int p_priority);
+	int get_priority() const { return priority.load(std::memory_order_relaxed); }
+
+	// 0 disables synchronization. Otherwise data packets carry this sync
+	// address and a sync packet follows every emit() that latches, which the
+	// owner does once per pass, after its last data packet.
+	void set_sync_universe(int universe);
+	int get_sync_universe() const { return sync_universe.load(std::memory_order_relaxed); }
+
+	// frame < 0 sends the live slabs, otherwise that committed frame slot.
+	bool emit(DmxUniverseBuffer *const *list, size_t count, int frame, bool latch) { return send(list, count, frame, 0, latch); }
+
+	uint64_t get_packets_sent() const { return packets_sent.load(std::memory_order_relaxed); }
+	void reset_counters() { packets_sent = 0; }
+};
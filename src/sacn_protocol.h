@@ -0,0 +1,120 @@
+#pragma once
+
+// ANSI E1.31 (sACN) wire format constants and helpers for the native send path.
+// Everything in here is plain C++ so it can be used outside of Godot types.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+static constexpr uint16_t SACN_DEFAULT_PORT = 5568;
+static constexpr uint16_t SACN_MIN_UNIVERSE = 1;
+static constexpr uint16_t SACN_MAX_UNIVERSE = 63999;
+static constexpr uint8_t SACN_DEFAULT_PRIORITY = 100;
+static constexpr uint8_t SACN_MAX_PRIORITY = 200;
+
+static constexpr size_t SACN_CID_SIZE = 16;
+static constexpr size_t SACN_SOURCE_NAME_SIZE = 64;
+
+// Everything up to and including the DMX start code; slot data follows.
+static constexpr size_t SACN_DATA_HEADER_SIZE = 126;
+static constexpr size_t SACN_SYNC_SIZE = 49;
+
+static constexpr uint32_t SACN_VECTOR_ROOT_DATA = 0x00000004;
+static constexpr uint32_t SACN_VECTOR_ROOT_EXTENDED = 0x00000008;
+static constexpr uint32_t SACN_VECTOR_FRAMING_DATA = 0x00000002;
+static constexpr uint32_t SACN_VECTOR_FRAMING_SYNC = 0x00000001;
+static constexpr uint8_t SACN_VECTOR_DMP_SET_PROPERTY = 0x02;
+
+// Framing layer option bits.
+static constexpr uint8_t SACN_OPTION_PREVIEW = 0x80;
+static constexpr uint8_t SACN_OPTION_STREAM_TERMINATED = 0x40;
+static constexpr uint8_t SACN_OPTION_FORCE_SYNC = 0x20;
+
+static constexpr uint8_t SACN_ACN_PACKET_ID[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+
+inline void sacn_write_u16(uint8_t *dst, uint16_t value) {
+	dst[0] = static_cast<uint8_t>(value >> 8);
+	dst[1] = static_cast<uint8_t>(value & 0xFF);
+}
+
+inline void sacn_write_u32(uint8_t *dst, uint32_t value) {
+	dst[0] = static_cast<uint8_t>(value >> 24);
+	dst[1] = static_cast<uint8_t>((value >> 16) & 0xFF);
+	dst[2] = static_cast<uint8_t>((value >> 8) & 0xFF);
+	dst[3] = static_cast<uint8_t>(value & 0xFF);
+}
+
+// PDU flags (0x7) and a 12-bit length covering the PDU from this field on.
+inline void sacn_write_flags_length(uint8_t *dst, size_t length) {
+	sacn_write_u16(dst, static_cast<uint16_t>(0x7000 | (length & 0x0FFF)));
+}
+
+// Every universe has its own multicast group, 239.255.<high>.<low>.
+// Returned in network byte order, like ArtNetAddress::ip.
+inline uint32_t sacn_multicast_ip(uint16_t universe) {
+	uint8_t bytes[4] = { 239, 255, static_cast<uint8_t>(universe >> 8), static_cast<uint8_t>(universe & 0xFF) };
+	uint32_t ip;
+	std::memcpy(&ip, bytes, sizeof(ip));
+	return ip;
+}
+
+// Root layer shared by data and sync packets (38 bytes).
+inline void sacn_write_root_layer(uint8_t *dst, uint32_t vector, const uint8_t *cid, size_t packet_size) {
+	sacn_write_u16(dst, 0x0010); // preamble size
+	sacn_write_u16(dst + 2, 0x0000); // postamble size
+	std::memcpy(dst + 4, SACN_ACN_PACKET_ID, sizeof(SACN_ACN_PACKET_ID));
+	sacn_write_flags_length(dst + 16, packet_size - 16);
+	sacn_write_u32(dst + 18, vector);
+	std::memcpy(dst + 22, cid, SACN_CID_SIZE);
+}
+
+// Writes the 126-byte E1.31 data packet header for slot_count DMX slots
+// (start code included). source_name must be SACN_SOURCE_NAME_SIZE bytes.
+inline void sacn_write_data_header(uint8_t *dst, const uint8_t *cid, const char *source_name, uint8_t priority, uint16_t sync_universe, uint8_t sequence, uint8_t options, uint16_t universe, uint16_t slot_count) {
+	size_t packet_size = SACN_DATA_HEADER_SIZE + slot_count;
+	sacn_write_root_layer(dst, SACN_VECTOR_ROOT_DATA, cid, packet_size);
+
+	// Framing layer.
+	sacn_write_flags_length(dst + 38, packet_size - 38);
+	sacn_write_u32(dst + 40, SACN_VECTOR_FRAMING_DATA);
+	std::memcpy(dst + 44, source_name, SACN_SOURCE_NAME_SIZE);
+	dst[108] = priority;
+	sacn_write_u16(dst + 109, sync_universe);
+	dst[111] = sequence;
+	dst[112] = options;
+	sacn_write_u16(dst + 113, universe);
+
+	// DMP layer.
+	sacn_write_flags_length(dst + 115, packet_size - 115);
+	dst[117] = SACN_VECTOR_DMP_SET_PROPERTY;
+	dst[118] = 0xA1; // address type and data type
+	sacn_write_u16(dst + 119, 0x0000); // first property address
+	sacn_write_u16(dst + 121, 0x0001); // address increment
+	sacn_write_u16(dst + 123, static_cast<uint16_t>(slot_count + 1));
+	dst[125] = 0x00; // DMX start code
+}
+
+// Updates the fields of a header written by sacn_write_data_header() that
+// change from packet to packet: sequence, options and every length derived
+// from the slot count.
+inline void sacn_patch_data_header(uint8_t *dst, uint8_t sequence, uint8_t options, uint16_t slot_count) {
+	size_t packet_size = SACN_DATA_HEADER_SIZE + slot_count;
+	sacn_write_flags_length(dst + 16, packet_size - 16);
+	sacn_write_flags_length(dst + 38, packet_size - 38);
+	dst[111] = sequence;
+	dst[112] = options;
+	sacn_write_flags_length(dst + 115, packet_size - 115);
+	sacn_write_u16(dst + 123, static_cast<uint16_t>(slot_count + 1));
+}
+
+// Writes a 49-byte E1.31 universe synchronization packet.
+inline void sacn_write_sync(uint8_t *dst, const uint8_t *cid, uint8_t sequence, uint16_t sync_universe) {
+	sacn_write_root_layer(dst, SACN_VECTOR_ROOT_EXTENDED, cid, SACN_SYNC_SIZE);
+	sacn_write_flags_length(dst + 38, SACN_SYNC_SIZE - 38);
+	sacn_write_u32(dst + 40, SACN_VECTOR_FRAMING_SYNC);
+	dst[44] = sequence;
+	sacn_write_u16(dst + 45, sync_universe);
+	dst[47] = 0; // reserved
+	dst[48] = 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free index handoff for a single-writer, single-reader triple buffer.
+// The caller owns three slots; the writer fills back(), the reader consumes
+// front(), and the third slot is parked in a shared atomic. Publishing and
+// acquiring are each one atomic exchange, so neither side ever waits.
+class TripleBufferIndex {
+	static constexpr uint8_t FRESH = 0x4;
+	static constexpr uint8_t INDEX_MASK = 0x3;
+
+	std::atomic<uint8_t> middle{ 1 };
+	uint8_t back_index = 0; // writer-owned
+	uint8_t front_index = 2; // reader-owned
+
+public:
+	void reset() {
+		back_index = 0;
+		middle.store(1, std::memory_order_relaxed);
+		front_index = 2;
+	}
+
+	uint8_t back() const { return back_index; }
+	uint8_t front() const { return front_index; }
+
+	// Writer: publishes the back slot and takes over the previous middle slot.
+	void publish() {
+		back_index = middle.exchange(static_cast<uint8_t>(back_index | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// Reader: switches to the most recently published slot if there is one.
+	// Returns true when front() changed.
+	bool acquire() {
+		if (!(middle.load(std::memory_order_acquire) & FRESH)) {
+			return false;
+		}
+		front_index = middle.exchange(front_index, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+};